@@ -0,0 +1,37 @@
+#ifndef LOOP_EXTRACTION_ACCESS_H
+#define LOOP_EXTRACTION_ACCESS_H
+
+#include "program.h"
+#include <map>
+#include <set>
+#include <string>
+
+namespace LE {
+
+  // collect variables that blocks, loops and functions may read and modify
+  //
+  // a block or a loop path modifies the variables it updates, and reads
+  // the variables in their values, in subscripts of their targets and
+  // in constraints
+  // a loop includes its paths, its declarations and its inner loops,
+  // a function includes its blocks, loops, constraints and return values
+  // it is one pass over the summary, so it costs time linear in its size
+  class AccessAnalysis {
+  private:
+    // accesses of loops analyzed so far, with their inner loops
+    std::map<Loop*, Access> loopAccesses;
+
+    static void addReads(SgExpression* expr, Access& access);
+    static void addUpdates(VariableTable* varTbl, Access& access);
+    static void addAll(const Access& from, Access& to);
+
+    const Access& analyzeLoop(Loop* loop);
+
+  public:
+    // results are saved in the function, see Function::getAccesses
+    static void analyze(Function* func);
+  };
+
+}
+
+#endif
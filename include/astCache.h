@@ -0,0 +1,41 @@
+#ifndef LOOP_EXTRACTION_AST_CACHE_H
+#define LOOP_EXTRACTION_AST_CACHE_H
+
+#include "rose.h"
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // on-disk cache of parsed ASTs, one binary file per source file
+  //
+  // a cached AST is keyed by the hash of the preprocessed source,
+  // of the command line flags and of the versions of the cache, ROSE
+  // and the compiler, so a file is parsed again when it or any header
+  // it includes changes, or when le is rebuilt against another ROSE
+  class AstCache {
+  private:
+    // directory of cached ASTs
+    std::string dir;
+
+    // whether an AST loaded from cache or parsed by frontend is alive
+    // memory pools must be cleared before another AST is loaded
+    bool hasAst;
+
+    // run preprocessor on file and hash its output with the flags
+    // return false if file can't be preprocessed
+    bool computeKey(const std::vector<std::string>& flags,
+                    const std::string& file, std::string& key);
+
+  public:
+    AstCache(const std::string& d);
+
+    // return project of a single file
+    // it is loaded from cache on a hit, otherwise it is parsed
+    // by frontend and written to cache
+    SgProject* load(const std::vector<std::string>& flags, const std::string& file);
+  };
+
+}
+
+#endif
@@ -3,6 +3,9 @@
 
 #include "rose.h"
 #include <string>
+#include <set>
+#include <map>
+#include <vector>
 #include <functional>
 
 namespace LE {
@@ -24,6 +27,39 @@ namespace LE {
     static void replaceVar(SgNode* tree,
       SgExpression* newValue, const std::string& name);
 
+    // return a copy of expr in which every variable in values
+    // is replaced with a copy of its value
+    // all variables are replaced at once, so a value inserted
+    // for one variable is never replaced again for another one
+    static SgExpression* substitute(SgExpression* expr,
+      const std::map<std::string, SgExpression*>& values);
+
+    // collect names of all variables referenced in an AST
+    static void collectVarNames(SgNode* tree, std::set<std::string>& names);
+
+    // operands of an expression in the order they are evaluated: those of
+    // an operator or an initializer, the condition and branches of a
+    // conditional expression, the arguments of a call
+    static std::vector<SgExpression*> getOperands(SgExpression* expr);
+
+    // visit an expression and its operands with an explicit stack instead
+    // of recursion, as generated code may nest expressions thousands of
+    // levels deep
+    // enter is called before the operands of an expression, which are
+    // skipped if it returns false, and leave after them, if given
+    // missing operands are visited as nullptr
+    static void traverse(SgExpression* tree,
+      const std::function<bool(SgExpression*)>& enter,
+      const std::function<void(SgExpression*)>& leave = nullptr);
+
+    // return name of the variable an operand name refers to
+    // e.g. 'arr[i]' -> 'arr', '(*p)' -> 'p', 'x' -> 'x'
+    static std::string getBaseName(const std::string& operand);
+
+    // whether an operand name is a plain variable
+    // e.g. 'x' is, but 'arr[i]' and '(*p)' are not
+    static bool isPlainName(const std::string& operand);
+
     // type must be subtype of SgCompoundAssignOp
     // with given SgCompoundAssignOp, return corresbonding binary operator
     // e.g. SgPlusAssignOp -> SgAddOp, SgMinusAssignOp -> SgMinusOp
@@ -34,9 +70,20 @@ namespace LE {
     // e.g. VariantT::V_SgEqualityOp -> '=='
     static std::string getOperatorString(VariantT type);
 
+    // whether a type is an integer, char or bool type
+    // values of such types are truncated toward zero
+    // false for unknown types, e.g. V_SgNode
+    static bool isIntegralType(VariantT type);
+    // typedefs and modifiers are stripped, false for nullptr
+    static bool isIntegralType(SgType* type);
+
     // map from int value of type to string
     // e.g. VariantT::V_INT -> "int"
     static std::string getTypeString(VariantT type);
+
+    // source location of a node, 'file:line'
+    // empty if the node has no location, e.g. it is built by us
+    static std::string getLocation(SgNode* node);
   };
 
 }
@@ -0,0 +1,35 @@
+#ifndef LOOP_EXTRACTION_BLOCK_COALESCING_H
+#define LOOP_EXTRACTION_BLOCK_COALESCING_H
+
+#include "program.h"
+
+namespace LE {
+
+  // fuse adjacent blocks of a function into one block
+  //
+  // block a and block b are fused if every path containing a
+  // runs b right after it, and every path containing b runs a
+  // right before it; the fused block keeps the name of a and
+  // the composition of both update maps
+  // blocks are not fused when a constraint is checked between them
+  class BlockCoalescing {
+  private:
+    // whether updates of a block only write plain variables
+    // updates through arrays or pointers can't be composed
+    static bool isComposable(Block* block);
+
+    // compose updates of second block after those of first block
+    // and save them in first block
+    static void compose(Block* first, Block* second);
+
+    // whether a constraint of path is checked right before block name
+    static bool isCheckedBefore(Path* path, const std::string& name);
+
+  public:
+    // fuse blocks of a function, return number of fused blocks
+    static int coalesce(Function* func);
+  };
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef LOOP_EXTRACTION_CALL_SUMMARY_H
+#define LOOP_EXTRACTION_CALL_SUMMARY_H
+
+#include "rose.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // summary of a function seen from its callers:
+  // its return value and its updates of non-local variables (e.g. globals),
+  // in terms of parameters and non-local variables at entry
+  // branches become conditional expressions, e.g.
+  //   int abs(int x) { if (x < 0) return -x; return x; }
+  // returns '((x < 0) ? (-x) : x)'
+  struct CallSummary {
+    std::vector<std::string> params;
+
+    // nullptr if function returns nothing
+    SgExpression* retVal;
+
+    std::map<std::string, SgExpression*> updates;
+
+    // references of updated variables
+    std::map<std::string, SgExpression*> targets;
+
+    // non-local variables the function reads or writes
+    std::set<std::string> nonLocals;
+  };
+
+  // summaries of functions called in extracted functions
+  //
+  // a callee is summarized once, the first time it is called,
+  // and its summary is instantiated at every call site
+  // by substituting arguments for parameters
+  //
+  // a callee can't be summarized if it has loops, writes through
+  // arrays or pointers, or is (mutually) recursive
+  // calls of such callees, and of functions defined elsewhere,
+  // are kept as they are
+  // so is a call whose callee reads or writes a non-local variable
+  // shadowed by a local of the extracted function, e.g. 'g' in
+  //   int g; void inc() { g++; } int f() { int g = 0; inc(); return g; }
+  class CallSummaries {
+  private:
+    // state of symbolic execution of a function body
+    struct State {
+      // current values of variables written so far
+      std::map<std::string, SgExpression*> values;
+
+      // condition under which function has returned, nullptr if never
+      SgExpression* returned;
+
+      // whether function has returned on every path
+      bool done;
+
+      // return value so far
+      SgExpression* result;
+
+      State(): returned(nullptr), done(false), result(nullptr) {}
+    };
+
+    // memoized summaries by defining declaration
+    // nullptr means the function can't be summarized
+    std::map<SgDeclarationStatement*, CallSummary*> summaries;
+
+    // functions being summarized, a call of them is recursive
+    std::set<SgDeclarationStatement*> inProgress;
+
+    // parameters and local variables of the function being summarized
+    std::set<std::string> locals;
+
+    // references of written variables, their values at entry
+    std::map<std::string, SgExpression*> entryRefs;
+
+    // parameters and local variables of the extracted function
+    std::set<std::string> callerLocals;
+
+    // whether a non-local of callee is shadowed by a local of the caller
+    bool isShadowed(CallSummary* summary) const;
+
+    // current value of a variable
+    SgExpression* current(State& state, const std::string& name);
+
+    // write a variable, keeping its old value on returned paths
+    void assign(State& state, const std::string& name, SgExpression* value);
+
+    // merge states of both branches of a condition into state
+    void merge(State& state, SgExpression* cond, State& t, State& f);
+
+    // evaluate an expression, applying its side effects to state
+    // return nullptr if it can't be summarized
+    SgExpression* evaluate(SgExpression* expr, State& state);
+
+    // execute a statement, return false if it can't be summarized
+    bool execute(SgStatement* stmt, State& state);
+
+    // summarize a function definition, nullptr if it can't be
+    CallSummary* summarize(SgFunctionDeclaration* funcDecl);
+
+    // replace calls below expr in place, return new root
+    SgExpression* replaceCalls(SgExpression* expr);
+
+    // whether an expression holds several summarized calls, one of them
+    // with updates, e.g. 'inc() + inc()', their return values depend on
+    // the order of the calls, which summaries in entry values don't model
+    bool hasOrderedCalls(SgExpression* expr);
+
+    // values of parameters at a call site
+    static std::map<std::string, SgExpression*> bind(
+      CallSummary* summary, const std::vector<SgExpression*>& args);
+
+  public:
+    // summary of the callee of a call
+    // nullptr if callee is not defined in this file or can't be summarized
+    CallSummary* getSummary(SgFunctionCallExp* call);
+
+    // whether callee of a call is defined in this file
+    static bool isDefined(SgFunctionCallExp* call);
+
+    // set parameters and local variables of the extracted function,
+    // whose calls are inlined next
+    void setCallerLocals(const std::set<std::string>& names) { callerLocals = names; }
+
+    // whether a call is kept as it is, with any side effect
+    bool isOpaque(SgFunctionCallExp* call);
+
+    // return a copy of expr where calls of summarized functions
+    // are replaced by their return values, unless it has ordered calls
+    SgExpression* inlineCalls(SgExpression* expr);
+
+    // updates of non-local variables by a call, instantiated with its arguments
+    std::map<std::string, SgExpression*> getUpdates(SgFunctionCallExp* call);
+
+    // forget summaries, e.g. before the AST they refer to is deleted
+    void clear() {
+      summaries.clear();
+      callerLocals.clear();
+    }
+  };
+
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define LOOP_EXTRACTION_CONSTRAINT_H
 
 #include "rose.h"
+#include <map>
+#include <string>
 #include <vector>
 
 namespace LE {
@@ -12,21 +14,40 @@ namespace LE {
   //
   // ConstraintList represents a list of constraint
   // that must all be met in a path
+  //
+  // a constraint of a function path is checked after the first steps of
+  // the path have run, and reads the values they leave, e.g. in
+  // 'x = n; if (x > 5)' the constraint 'x > 5' is at step 1, after the
+  // block of 'x = n'
+  // a constraint of a loop path reads values at the start of the
+  // iteration, its step is always 0
   class ConstraintList {
   private:
     // list of constraints
     std::vector<SgExpression*> constraints;
 
+    // number of steps run before each constraint is checked, nondecreasing
+    std::vector<size_t> steps;
+
   public:
-    // add a constraint
-    void addConstraint(SgExpression* expr) { constraints.push_back(expr); }
+    // add a constraint checked after step steps of the path
+    void addConstraint(SgExpression* expr, size_t step = 0) {
+      constraints.push_back(expr);
+      steps.push_back(step);
+    }
 
     ConstraintList() {}
-    ConstraintList(const std::vector<SgExpression*>& c): constraints(c) {}
+    ConstraintList(const std::vector<SgExpression*>& c, const std::vector<size_t>& s):
+      constraints(c), steps(s) {}
 
     // clone of a ConstraintList
     // note: elements(SgExpression*) in constraints are copied shallowly
-    ConstraintList* clone() const { return new ConstraintList(constraints); }
+    ConstraintList* clone() const { return new ConstraintList(constraints, steps); }
+
+    inline size_t size() const { return constraints.size(); }
+    inline SgExpression* get(size_t i) const { return constraints[i]; }
+    inline size_t getStep(size_t i) const { return steps[i]; }
+    inline void setStep(size_t i, size_t step) { steps[i] = step; }
 
     typedef std::vector<SgExpression*>::iterator iterator;
     typedef std::vector<SgExpression*>::const_iterator const_iterator;
@@ -37,6 +58,49 @@ namespace LE {
     inline const_iterator end() const { return constraints.end(); }
   };
 
+  // paths arranged in a prefix tree keyed by their printed constraints,
+  // paths sharing their first constraints share the nodes of them,
+  // an end is what a printer prints for a path ending at a node
+  template <class T>
+  struct ConstraintTree {
+    // keys of children in the order they were added
+    std::vector<std::string> order;
+    std::map<std::string, ConstraintTree*> children;
+    std::vector<T> ends;
+
+    ConstraintTree() {}
+    ConstraintTree(const ConstraintTree&) = delete;
+    ConstraintTree& operator=(const ConstraintTree&) = delete;
+
+    // children are deleted with an explicit stack, trees are as deep
+    // as paths are long
+    ~ConstraintTree() {
+      std::vector<ConstraintTree*> stack;
+      for (auto& child : children) stack.push_back(child.second);
+      while (!stack.empty()) {
+        ConstraintTree* node = stack.back();
+        stack.pop_back();
+        for (auto& child : node->children) stack.push_back(child.second);
+        node->children.clear();
+        delete node;
+      }
+    }
+
+    // add a path with its keys, in the order they are checked
+    void add(const std::vector<std::string>& keys, const T& end) {
+      ConstraintTree* node = this;
+      for (const std::string& key : keys) {
+        ConstraintTree*& child = node->children[key];
+        if (child == nullptr) {
+          child = new ConstraintTree();
+          node->order.push_back(key);
+        }
+        node = child;
+      }
+      node->ends.push_back(end);
+    }
+  };
+
 }
 
 #endif
@@ -0,0 +1,131 @@
+#ifndef LOOP_EXTRACTION_DEPENDENCE_H
+#define LOOP_EXTRACTION_DEPENDENCE_H
+
+#include "program.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // find loop-carried dependences through arrays
+  //
+  // reads and writes of arrays in a loop and its inner loops are
+  // collected with their subscripts, and each pair of accesses of the
+  // same array, one of them a write, is tested for a dependence between
+  // different iterations
+  // subscripts must be affine in induction variables of the nest,
+  // i.e. variables every iteration adds the same constant to,
+  // e.g. 'a[2 * i + 1]', otherwise the dependence is assumed
+  //
+  // for each dimension of the subscripts
+  // - ZIV: no induction variable, constants must be equal
+  // - strong SIV: same induction variable with the same coefficient
+  //   on both sides, it gives the distance at the level of its loop
+  // - otherwise, the GCD of the coefficients must divide the
+  //   difference of the constants
+  //
+  // accesses with different base names are assumed not to overlap only
+  // if both bases are declared arrays, not parameters, or one of them is
+  // a restrict pointer, otherwise a write and an access of another base
+  // are an 'unknown' dependence carried by the loop
+  class DependenceAnalysis {
+  private:
+    // sum of coefficient * variable and a constant
+    struct Affine {
+      std::map<std::string, long> coeffs;
+      long constant;
+
+      Affine(): constant(0) {}
+    };
+
+    // an access of an array in a loop of the nest
+    struct Access {
+      std::string array;
+
+      // printed access, e.g. 'a[(i + 1)]'
+      std::string text;
+
+      std::vector<SgExpression*> subscripts;
+      bool write;
+
+      // the base is a declared array, not a parameter
+      bool object;
+      // the base is a restrict pointer
+      bool restricted;
+
+      // loops from the analyzed loop to the loop of the access
+      std::vector<Loop*> nest;
+    };
+
+    std::vector<Access> accesses;
+
+    // printed accesses with their loop, to collect each access once
+    std::set<std::string> collected;
+
+    // induction variables of loops of the nest and their steps
+    std::map<Loop*, std::map<std::string, long> > inductions;
+
+    // variables updated or declared in the nest
+    std::set<std::string> modified;
+
+    // variables declared in the nest, they are private to an iteration
+    std::set<std::string> declared;
+
+    // writes through pointers
+    std::vector<Dependence> unknown;
+
+    // value of an integer constant
+    static bool getConstant(SgExpression* expr, long& value);
+
+    // step of an update of name, e.g. '(i + 2)' -> 2
+    static bool getStep(SgExpression* value, const std::string& name, long& step);
+
+    // collect variables updated in a loop and its inner loops
+    static void collectWritten(Loop* loop, std::set<std::string>& names,
+                               std::set<Loop*>& visited);
+
+    // variables every iteration of a loop adds the same constant to
+    // and its inner loops don't update
+    void findInductions(Loop* loop);
+
+    // induction variable of a loop of the nest
+    bool isInduction(const std::string& name) const;
+
+    // index of the first of depth loops of nest name is an induction
+    // variable of, -1 if none
+    int getLevel(const std::string& name, const std::vector<Loop*>& nest,
+                 size_t depth) const;
+
+    // affine form of a subscript, false if it isn't affine or
+    // reads a variable updated in the nest that is not an induction variable
+    bool toAffine(SgExpression* expr, Affine& result) const;
+
+    void addAccess(SgPntrArrRefExp* ref, bool write, const std::vector<Loop*>& nest);
+
+    // whether accesses of different bases may touch the same memory
+    static bool mayAlias(const Access& a, const Access& b);
+
+    // collect array reads in an expression
+    void collectReads(SgExpression* expr, const std::vector<Loop*>& nest);
+
+    // collect accesses and updated variables of a loop and its inner loops
+    void collectAccesses(Loop* loop, std::vector<Loop*>& nest);
+
+    // test for a dependence from src to sink in a later iteration,
+    // return false if there is none or it is loop-independent
+    bool test(const Access& src, const Access& sink, Dependence& dep) const;
+
+    // analyze a single loop
+    void analyzeLoop(Loop* loop);
+
+  public:
+    // analyze a loop and its inner loops
+    // results are saved in loops, see Loop::getDependences
+    static void analyze(Loop* loop);
+  };
+
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef LOOP_EXTRACTION_DIAGNOSTICS_H
+#define LOOP_EXTRACTION_DIAGNOSTICS_H
+
+#include <string>
+
+namespace LE {
+
+  // collect warnings of loop extraction away from stdout
+  //
+  // warnings are counted by kind (the message) and by source location
+  // the first few of each kind are written to stderr, or as JSON lines
+  // to a side file, repeated ones are only counted
+  // a summary of all counts is written at exit
+  // forked workers write nothing, their warnings within the limit are
+  // sent with their counts and the parent writes them, so that the limit
+  // holds over all workers
+  class Diagnostics {
+  public:
+    // write diagnostics as JSON lines to file instead of stderr
+    // empty file means stderr
+    // at most limit warnings of each kind are written
+    static void configure(const std::string& file, int limit);
+
+    // count a warning and write it unless its kind is over limit
+    // location is 'file:line', or empty if unknown
+    static void report(const std::string& message, const std::string& location);
+
+    // counts and unwritten warnings of this process,
+    // to be merged into parent by workers
+    static std::string serialize();
+    static void merge(const std::string& counts);
+
+    // forget counts but keep how many warnings are written
+    // e.g. in a forked worker, whose counts are merged into parent
+    static void reset();
+
+    // keep warnings to be written by the parent instead of writing them
+    static void defer();
+
+    // start a task of a worker, whose warnings may be dropped by rollback
+    // if it fails, since the parent runs it again and reports them itself
+    static void mark();
+    static void rollback();
+
+    // write summary table of all counts
+    static void summary();
+  };
+
+}
+
+#endif
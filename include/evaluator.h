@@ -0,0 +1,226 @@
+#ifndef LOOP_EXTRACTION_EVALUATOR_H
+#define LOOP_EXTRACTION_EVALUATOR_H
+
+#include "program.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // operations of the bytecode
+  // the bytecode is a stack machine, every operation works
+  // on a whole batch of values (one per evaluation) at once
+  enum OpCode {
+    OP_CONST, OP_LOAD,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_IDIV, OP_MOD,
+    OP_LT, OP_GT, OP_LE, OP_GE, OP_EQ, OP_NE,
+    OP_AND, OP_OR, OP_NOT, OP_NEG,
+    OP_BITAND, OP_BITOR, OP_BITXOR, OP_BITNOT, OP_SHL, OP_SHR,
+    OP_TRUNC, OP_POP,
+    // c ? a : b, e.g. from summaries of callees
+    OP_SELECT
+  };
+
+  struct Instruction {
+    OpCode op;
+    // variable slot of OP_LOAD
+    int slot;
+    // value of OP_CONST
+    double value;
+
+    Instruction(OpCode o, int s = 0, double v = 0): op(o), slot(s), value(v) {}
+  };
+
+  // code of a single expression, leaves its value on the stack
+  typedef std::vector<Instruction> Code;
+
+  // slot <- value, all updates of a block or a loop path
+  // are applied at once
+  struct CompiledUpdate {
+    int slot;
+    Code code;
+  };
+
+  struct CompiledLoopPath {
+    std::vector<Code> constraints;
+    std::vector<CompiledUpdate> updates;
+    // indices of inner loops, run after updates
+    std::vector<int> innerLoops;
+    bool canBreak;
+  };
+
+  struct CompiledLoop {
+    // initialization of variables declared in the loop
+    std::vector<CompiledUpdate> init;
+    std::vector<CompiledLoopPath> paths;
+  };
+
+  // a step of a path is a block or a loop
+  struct CompiledStep {
+    bool isLoop;
+    int index;
+  };
+
+  struct CompiledPath {
+    std::string name;
+    std::vector<Code> constraints;
+    // number of steps run before each constraint is checked
+    std::vector<size_t> constraintSteps;
+    std::vector<CompiledStep> steps;
+    Code retVal;
+    // the function returns after this path even if regions follow
+    bool isReturn;
+  };
+
+  class Batch;
+
+  // a function compiled by Evaluator
+  //
+  // the summary is evaluated as follows:
+  // 1. inputs are stored in parameters, other variables are 0, or
+  //    sampled values for free variables when witnesses are searched
+  // 2. variables with initial values are initialized
+  // 3. paths are tried in order from the values of step 2, blocks and
+  //    loops of a path are run in order, every block (and every loop
+  //    path) updates its variables at once, and each constraint is
+  //    checked once the steps before it have run, see ConstraintList
+  // 4. the first path whose constraints all hold is taken
+  // 5. the return value of the path is the result
+  //
+  // with -le:regions, steps 3 and 4 are repeated for every region in
+  // order until a path returns or the last region is done
+  //
+  // a loop repeatedly chooses its first path whose constraints hold,
+  // applies its updates, runs its inner loops, and stops after a path
+  // that breaks the loop
+  class CompiledFunction {
+  private:
+    friend class Evaluator;
+
+    std::vector<std::string> inputs;
+    // slot of every input
+    std::vector<int> inputSlots;
+    // variables other than parameters that may be read before they are
+    // assigned, i.e. globals and locals declared without initial value
+    std::vector<std::string> freeVars;
+    std::vector<int> freeSlots;
+    // whether a slot holds an integer variable
+    std::vector<bool> integral;
+    std::vector<CompiledUpdate> init;
+    std::vector<std::vector<CompiledUpdate> > blocks;
+    std::vector<CompiledLoop> loops;
+    std::vector<CompiledPath> paths;
+    // end of the paths of each region, a single region if
+    // the function is not split
+    std::vector<size_t> regionEnds;
+    // deepest stack needed by any code
+    size_t maxDepth;
+    // iterations a loop may run before it's given up
+    long maxIterations;
+
+    // evaluate code for lanes of a batch, result is written to out
+    void run(const Code& code, Batch& batch, double* out) const;
+
+    // apply count updates to lanes whose mask is set
+    void apply(const CompiledUpdate* updates, size_t count,
+               const char* mask, Batch& batch) const;
+    inline void apply(const std::vector<CompiledUpdate>& updates,
+                      const char* mask, Batch& batch) const {
+      apply(updates.data(), updates.size(), mask, batch);
+    }
+
+    // run a loop for lanes whose mask is set
+    void runLoop(int index, const char* mask, Batch& batch) const;
+
+    // try path p for lanes whose mask is set, from the current values
+    // the mask is cleared for lanes failing a constraint or a loop
+    // return whether any step was run, i.e. values may have changed
+    bool tryPath(size_t p, char* mask, Batch& batch) const;
+
+    // store inputs and free variables of a batch and initialize variables
+    // free variables are 0 if free is empty
+    void load(const std::vector<const double*>& in, const std::vector<const double*>& free,
+              size_t offset, Batch& batch) const;
+
+    // evaluate a batch of at most Batch::width lanes
+    // if witnesses is not null, the first lane taking a path without
+    // witness becomes its witness
+    void evaluateBatch(const std::vector<const double*>& in,
+                       const std::vector<const double*>& free, size_t offset,
+                       Batch& batch, double* results, int* chosen,
+                       std::vector<long>* witnesses) const;
+
+  public:
+    CompiledFunction(): maxDepth(1), maxIterations(1000000) {}
+
+    // names of inputs (the parameters) in the order evaluate expects them
+    inline const std::vector<std::string>& getInputs() const { return inputs; }
+
+    inline size_t getPathCount() const { return paths.size(); }
+    inline const std::string& getPathName(size_t i) const { return paths[i].name; }
+    // whether the k-th input is an integer, so it's truncated
+    inline bool isIntegral(size_t k) const { return integral[inputSlots[k]]; }
+
+    // names of free variables in the order findWitnesses expects them
+    inline const std::vector<std::string>& getFreeVars() const { return freeVars; }
+    inline bool isFreeIntegral(size_t k) const { return integral[freeSlots[k]]; }
+    inline void setMaxIterations(long n) { maxIterations = n; }
+
+    // evaluate the function for n inputs laid out as structure-of-arrays:
+    // inputs[k][i] is the value of the k-th input in the i-th evaluation
+    // results[i] is the return value, NaN if no path matched
+    // or a loop did not terminate
+    // if paths is not null, paths[i] is the index of the chosen path or -1
+    void evaluate(const std::vector<const double*>& inputs, size_t n,
+                  double* results, int* paths = nullptr) const;
+
+    // find inputs for which evaluation takes each path
+    // free[k][i] is the value of the k-th free variable in the i-th
+    // evaluation, free may be empty to keep them 0
+    // witnesses[p] is the index of the first of n inputs found for path p,
+    // or -1, paths with a witness already keep it
+    // return the number of paths without witness
+    size_t findWitnesses(const std::vector<const double*>& inputs,
+                         const std::vector<const double*>& free, size_t n,
+                         std::vector<long>& witnesses) const;
+  };
+
+  // compile a Function into bytecode of CompiledFunction
+  class Evaluator {
+  private:
+    CompiledFunction* result;
+
+    // slots of variables by name
+    std::map<std::string, int> slots;
+
+    // loop index by name
+    std::map<std::string, int> loopIndex;
+
+    // reason why compile failed, empty if it didn't
+    std::string error;
+
+    int getSlot(const std::string& name);
+    void setIntegral(int slot, VariantT type);
+
+    void compileExpr(SgExpression* expr, Code& code);
+    Code compileCode(SgExpression* expr);
+    std::vector<CompiledUpdate> compileUpdates(VariableTable* varTbl);
+    int compileLoop(Loop* loop);
+    void compilePaths(Function* scope, const std::map<std::string, int>& blockIndex,
+                      const std::map<std::string, Loop*>& loops);
+    void compileFunction(Function* func);
+
+    Evaluator(): result(new CompiledFunction) {}
+
+  public:
+    // compile a function
+    // return nullptr if it uses features the bytecode can't express,
+    // e.g. arrays, pointers or function calls
+    static CompiledFunction* compile(Function* func);
+  };
+
+}
+
+#endif
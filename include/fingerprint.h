@@ -0,0 +1,26 @@
+#ifndef LOOP_EXTRACTION_FINGERPRINT_H
+#define LOOP_EXTRACTION_FINGERPRINT_H
+
+#include "rose.h"
+#include <string>
+
+namespace LE {
+
+  // fingerprint of a function definition, computed before extraction
+  //
+  // it is a hash of the normalized AST: the kind and number of children
+  // of each node, names of the function, variables and their types,
+  // and constant values, but no source positions, comments or spelling
+  // a function defined in the same file and called by it is part of
+  // the fingerprint too, as its summary is inlined, see CallSummaries
+  // e.g. a static inline helper of a header has the same fingerprint
+  // in every file that includes it
+  class Fingerprint {
+  public:
+    // 16 hex digits
+    static std::string compute(SgFunctionDeclaration* funcDecl);
+  };
+
+}
+
+#endif
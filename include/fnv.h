@@ -0,0 +1,29 @@
+#ifndef LOOP_EXTRACTION_FNV_H
+#define LOOP_EXTRACTION_FNV_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace LE {
+
+  // 64-bit FNV-1a hash, e.g. of cached ASTs and function fingerprints
+  // a hash starts at fnvOffset and is updated in place
+  static const uint64_t fnvOffset = 14695981039346656037ULL;
+  static const uint64_t fnvPrime = 1099511628211ULL;
+
+  inline void hashBytes(uint64_t& hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      hash ^= static_cast<unsigned char>(data[i]);
+      hash *= fnvPrime;
+    }
+  }
+
+  inline void hashString(uint64_t& hash, const std::string& str) {
+    // include terminating '\0' so that 'ab', 'c' differs from 'a', 'bc'
+    hashBytes(hash, str.c_str(), str.size() + 1);
+  }
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef LOOP_EXTRACTION_INVARIANT_H
+#define LOOP_EXTRACTION_INVARIANT_H
+
+#include "program.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // find loop-invariant variables and subexpressions
+  //
+  // a variable is invariant in a loop if no path of the loop
+  // or of its inner loops updates it and it is not declared in them
+  // a subexpression of a constraint or an update is invariant
+  // if it only reads invariant variables and constants
+  class InvariantAnalysis {
+  private:
+    // variables updated or declared in the loop
+    std::set<std::string> modified;
+
+    // whether the loop writes through an array or a pointer
+    // if it does, every array or pointer read may change
+    bool writesMemory;
+
+    // cache of isInvariant
+    std::map<SgExpression*, bool> invariant;
+
+    // collect variables updated or declared in a loop and its inner loops
+    void collectModified(Loop* loop, std::set<Loop*>& visited);
+
+    // whether value of an expression is the same in every iteration
+    bool isInvariant(SgExpression* expr);
+
+    // collect largest invariant subexpressions that are not
+    // a single variable or constant
+    void collectInvariantExprs(SgExpression* expr, std::vector<SgExpression*>& exprs,
+                               std::set<std::string>& printed);
+
+    // analyze a single loop
+    void analyzeLoop(Loop* loop);
+
+    InvariantAnalysis(): writesMemory(false) {}
+
+  public:
+    // analyze a loop and its inner loops
+    // results are saved in loops, see Loop::getInvariantVars
+    static void analyze(Loop* loop);
+  };
+
+}
+
+#endif
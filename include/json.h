@@ -0,0 +1,28 @@
+#ifndef LOOP_EXTRACTION_JSON_H
+#define LOOP_EXTRACTION_JSON_H
+
+#include <string>
+
+namespace LE {
+
+  // quote a string for JSON, e.g. in diagnostics and trace events
+  // control characters become spaces, as lines must not break
+  inline std::string jsonString(const std::string& str) {
+    std::string result = "\"";
+    for (char c : str) {
+      if (c == '"' || c == '\\') {
+        result += '\\';
+        result += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        result += ' ';
+      } else {
+        result += c;
+      }
+    }
+    result += '"';
+    return result;
+  }
+
+}
+
+#endif
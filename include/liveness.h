@@ -0,0 +1,70 @@
+#ifndef LOOP_EXTRACTION_LIVENESS_H
+#define LOOP_EXTRACTION_LIVENESS_H
+
+#include "program.h"
+#include <map>
+#include <set>
+#include <string>
+
+namespace LE {
+
+  // backward liveness analysis over the paths of a function
+  // it removes updates of blocks and loop paths whose values are never read
+  //
+  // a variable is live if it is read later on some path, by a block,
+  // a loop, a constraint or the return value
+  // variables not declared in the function (e.g. globals) and
+  // updates through arrays or pointers are always live
+  class LivenessAnalysis {
+  private:
+    // variables declared in the function and its loops
+    std::set<std::string> locals;
+
+    // variables read by initial values of declarations in the function
+    std::set<std::string> initReads;
+
+    // blocks and top-level loops of the function by name
+    std::map<std::string, Block*> blocks;
+    std::map<std::string, Loop*> loops;
+
+    // updates of blocks that are live on some path
+    std::map<Block*, std::set<std::string> > liveUpdates;
+
+    // variables live after a top-level loop on some path
+    std::map<Loop*, std::set<std::string> > loopLiveOut;
+
+    // collect declared variables of a loop and its inner loops
+    void collectLocals(Loop* loop);
+
+    // whether an update of a variable must be kept
+    // when live variables after it are given
+    bool isNeeded(const std::string& name, const std::set<std::string>& live);
+
+    // add variables read by an update, including variables
+    // in the subscript of an array update
+    void addReads(const std::string& name, Variable* var, std::set<std::string>& live);
+
+    // live variables before a block, given live variables after it
+    void handleBlock(Block* block, std::set<std::string>& live);
+
+    // variables live at the head of a loop, given live variables after it
+    std::set<std::string> computeLoopLive(Loop* loop, const std::set<std::string>& liveOut);
+
+    // walk a path backward from variables live after it
+    // return variables live before it
+    std::set<std::string> handlePath(Path* path, const std::set<std::string>& liveOut);
+
+    // remove dead updates in paths of a loop and its inner loops
+    void pruneLoop(Loop* loop, const std::set<std::string>& liveOut);
+
+    // remove dead updates in blocks and loops of a function
+    void run(Function* func);
+
+  public:
+    // remove dead updates in blocks and loop paths of a function
+    static void eliminateDeadUpdates(Function* func);
+  };
+
+}
+
+#endif
@@ -3,6 +3,15 @@
 
 #include "rose.h"
 #include "program.h"
+#include "options.h"
+#include "printer.h"
+#include "callSummary.h"
+#include "profile.h"
+#include "selector.h"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace LE {
 
@@ -10,16 +19,85 @@ namespace LE {
   // a project forms a tree structure
   // like recursive descent in complier
   // I define a function for a kind of node in project tree
+  //
+  // it is also the interface of the library lible.a, e.g.
+  //   LE::LoopExtraction le({ "-le:no-dedup" });
+  //   le.setFunctionCallback([](LE::Program* p, LE::Function* f) { ... });
+  //   std::vector<LE::Program*> programs = le.extractFiles({ "test.c" });
+  // programs refer to the AST they are extracted from and are owned by the caller
+  // the AST parsed by extractFiles is deleted with the extractor, so the
+  // extractor must outlive the programs
+  // invalid options, patterns or files throw Error, see Message
   class LoopExtraction {
+  public:
+    // called with each function once it is extracted
+    // with -le:stream, the program is deleted once its file is extracted
+    typedef std::function<void(Program*, Function*)> FunctionCallback;
+
   private:
     SgProject *project;
 
+    // projects parsed by extractFiles, kept for the programs referring to
+    // them and deleted with the extractor
+    std::vector<SgProject*> parsed;
+
+    // keep programs in memory instead of printing them, see Extractor
+    bool embedded;
+
+    // programs extracted in embedded mode
+    std::vector<Program*> programs;
+
+    // callback of extracted functions, may be empty
+    FunctionCallback callback;
+
+    // options given on command line, see Options
+    Options options;
+
+    // arguments passed to ROSE frontend
+    std::vector<std::string> args;
+
+    // summaries of called functions, see CallSummaries
+    CallSummaries calls;
+
+    // 'file:function' extracted first by fingerprint, see Fingerprint
+    // kept across files, so a function is extracted once per run
+    std::map<std::string, std::string> fingerprints;
+
+    // functions and files selected by -le:function and -le:file
+    Selector selector;
+
+    // profile given by -le:profile, nullptr if none
+    Profile* profile;
+
+    // parse args with ROSE frontend
+    SgProject* parse();
+
+    // load the profile given by -le:profile
+    void loadProfile();
+
+    // whether a function gets every pass, i.e. there is no profile
+    // or its weight in the profile reaches the threshold
+    bool isHot(SgFunctionDeclaration* funcDecl) const;
+
     // so far, there are three types of operands that have name
     // a variable, a pointer or an array
     // return name of operand
     // e.g 'var', 'arr[i]', '*p'
     std::string getOperandName(SgExpression* expr);
 
+    // expr with plain variables replaced by their current values in varTbl
+    // e.g. a condition of a loop path read at the start of the iteration
+    SgExpression* currentValues(SgExpression* expr, VariableTable* varTbl);
+
+    // reference written by an update of a non-plain operand, e.g. 'arr[i]',
+    // with variables replaced by their current values in varTbl
+    // nullptr for plain variables
+    SgExpression* getTarget(SgExpression* operand, VariableTable* varTbl);
+
+    // create the printer selected by options
+    // globals are global variables of the file being printed
+    Printer* createPrinter(VariableTable* globals);
+
     // add loop to paths and function and return the loop
     Loop* saveLoopInFunction(Function* func);
 
@@ -38,6 +116,80 @@ namespace LE {
     // record variable updates in an expression
     void handleExpression(SgExpression* expr, VariableTable* varTbl);
 
+    // record the update of a single operator, e.g. '=', '++' or a call
+    // after its operands are handled
+    void handleUpdate(SgExpression* expr, VariableTable* varTbl);
+
+    // statements are handled with an explicit stack of pending tasks
+    // instead of recursion, as generated code may nest thousands of levels deep
+    // a statement handler never calls another one except as its last step,
+    // it schedules what follows instead
+    typedef std::function<void()> Task;
+    std::vector<Task> pending;
+
+    // run tasks in order, before tasks scheduled earlier
+    void schedule(const std::vector<Task>& tasks);
+
+    // run pending tasks until only base tasks are left
+    void runPending(size_t base);
+
+    // with -le:fast, conditions under which the branches being handled
+    // are taken, the innermost last
+    // an update in a branch keeps the old value if its guard doesn't hold
+    std::vector<SgExpression*> guards;
+
+    // with -le:fast, return values of paths that returned in a branch,
+    // the value after a later return is still to be set as false expression
+    std::map<Path*, SgConditionalExp*> openReturns;
+
+    // with -le:fast, paths that returned in each branch being handled,
+    // the innermost last, a true branch is followed by its false branch
+    std::vector<std::set<Path*> > branchReturns;
+
+    // with -le:fast, condition under which the function has returned in a
+    // branch, nullptr if it hasn't, later updates keep their old values then
+    SgExpression* returned;
+
+    // with -le:fast, guards, branch returns and returned of the code around
+    // the loops being handled, the innermost last
+    // a loop body is handled without them, they hold for the loop as a
+    // whole and not in terms of the values of each iteration
+    struct GuardState {
+      std::vector<SgExpression*> guards;
+      std::vector<std::set<Path*> > branchReturns;
+      SgExpression* returned;
+    };
+    std::vector<GuardState> suspended;
+
+    // save and clear guards when a loop handler starts
+    void suspendGuards();
+    // restore them when it finishes
+    void resumeGuards();
+
+    // value of an update guarded by the innermost guard, see guards,
+    // and not made once the function has returned, see returned
+    // old is the value if the guard doesn't hold
+    SgExpression* guardValue(SgExpression* value, SgExpression* old, VariableTable* varTbl);
+
+    // set the last false expression of an open return, and the path returns
+    void closeReturn(Path* path, SgExpression* value);
+
+    // after both branches of an if, paths that returned in both
+    // returned under the outer guard, or for good at the top
+    void joinBranchReturns();
+
+    // add a block that returns retVal to paths that haven't returned
+    void returnFromPaths(Function* func, const std::string& blockName, SgExpression* retVal);
+
+    // mark current loop paths canBreak = true, with -le:fast in a branch
+    // fork paths that break under the guard instead
+    void breakLoopPaths(Loop* loop);
+
+    // with -le:fast, handle both branches of an if on the same paths,
+    // each under its guard, instead of forking paths
+    void handleGuardedBranches(SgExpression* condition, const Task& trueBranch,
+                               const Task& falseBranch);
+
     // record variable updates in expression
     void handleExprInLoop(SgExpression* expr, Loop* loop);
 
@@ -70,9 +222,16 @@ namespace LE {
     // extract a loop from a for statement
     void handleForStatement(SgForStatement* forStmt, Loop* loop);
 
+    // create paths of a for loop after its init statements
+    // begin is when its handler started, for the trace
+    void handleForLoopPaths(SgForStatement* forStmt, Loop* loop, long begin);
+
     // extract a loop from a do-while statement
     void handleDoWhileStatement(SgDoWhileStmt* doStmt, Loop* loop);
 
+    // fork paths of a do-while loop at its condition, after its body
+    void handleDoWhileCondition(SgDoWhileStmt* doStmt, Loop* loop);
+
     // handle a general statement in a loop
     // it delegates jobs to other concrete statements
     void handleStmtInLoop(SgStatement* stmt, Loop* loop);
@@ -84,26 +243,68 @@ namespace LE {
     // traverse statements in a block of a loop
     void handleBlockInLoop(SgStatementPtrList& stmts, Loop* loop);
 
-    // traverse statements in a block of a path
-    void handleBlockInFunction(SgStatementPtrList& stmts, Function* func);
+    // traverse statements in a block of a path, from the first-th on
+    void handleBlockInFunction(SgStatementPtrList& stmts, Function* func, size_t first = 0);
+
+    // first statements of the regions of a function body, see -le:regions
+    // a region ends after a top-level if, except that the region holding
+    // the first return runs to the end, as a return leaves the function
+    // a body with goto or labels is one region
+    std::vector<size_t> splitRegions(SgStatementPtrList& stmts);
 
     // extract paths from a function
     void handleSgFunction(SgFunctionDeclaration* funcDecl, Function* func);
 
+    // extract functions in forked workers, see WorkerPool
+    // return printed functions in declaration order
+    std::vector<std::string> handleFunctionsInWorkers(
+      const std::vector<SgFunctionDeclaration*>& funcDecls, VariableTable* globals);
+
     // extract paths from a list of global functions
-    void handleSgGlobal(SgGlobal* global, Program* program);
+    // if functions are extracted in workers, they are not added to program
+    // but printed into functions
+    void handleSgGlobal(SgGlobal* global, Program* program,
+                        std::vector<std::string>& functions);
 
     // extract paths from a source file
     void handleSgSourceFile(SgSourceFile* src);
 
+    // unparse a source file annotated with OpenMP pragmas
+    // next to it, e.g. 'test.c' -> 'test.omp.c'
+    void writeAnnotatedSource(SgSourceFile* src);
+
     // extract paths from a list of files
     void handleSgFileList(SgFileList* fileList);
 
+    // parse files one by one, extract and print each of them
+    // and delete its AST before parsing the next one
+    void handleFilesInStream();
+
   public:
     LoopExtraction (int argc, char* argv[]);
 
+    // embedded mode, options are '-le:' options only
+    // programs are kept in memory instead of printed
+    // and functions are always extracted in this process
+    explicit LoopExtraction(const std::vector<std::string>& leOptions);
+
+    ~LoopExtraction();
+    LoopExtraction(const LoopExtraction&) = delete;
+    LoopExtraction& operator=(const LoopExtraction&) = delete;
+
+    inline void setFunctionCallback(const FunctionCallback& cb) { callback = cb; }
+
     // extract paths from a project
     void handleSgProject();
+
+    // embedded mode: parse files and extract their programs
+    // args are source files and flags of ROSE
+    // with -le:stream, no programs are returned, each one is only seen by
+    // the function callback and deleted once its file is extracted
+    std::vector<Program*> extractFiles(const std::vector<std::string>& args);
+
+    // embedded mode: extract programs of a project parsed by the caller
+    std::vector<Program*> extractProject(SgProject* proj);
   };
 
 }
@@ -1,24 +1,36 @@
 #ifndef LOOP_EXTRACTION_MESSAGE_H
 #define LOOP_EXTRACTION_MESSAGE_H
 
+#include "diagnostics.h"
+#include <stdexcept>
 #include <string>
-#include <iostream>
-#include <cstdlib>
 
 namespace LE {
 
+  // error of loop extraction, e.g. an invalid option or an unwritable
+  // database, reported to the caller of the library
+  // the le tool prints it and exits
+  class Error: public std::runtime_error {
+  public:
+    explicit Error(const std::string& message): std::runtime_error(message) {}
+  };
+
   // output message to user
   class Message {
   public:
-    // output warning
+    // output warning, see Diagnostics
     static inline void warning(const std::string& message) {
-      std::cout << "LOOP EXTRACTION WARNING: " << message << std::endl;
+      Diagnostics::report(message, "");
+    }
+
+    // output warning at a source location ('file:line')
+    static inline void warning(const std::string& message, const std::string& location) {
+      Diagnostics::report(message, location);
     }
 
-    // output error, process will be terminated
-    static inline void error(const std::string& message) {
-      std::cout << "LOOP EXTRACTION ERROR: " << message << std::endl;
-      std::exit(1);
+    // report error to the caller, see Error
+    [[noreturn]] static inline void error(const std::string& message) {
+      throw Error(message);
     }
   };
 
@@ -11,29 +11,40 @@ namespace LE {
   private:
     // id, every time allocLoopName() is called
     // it will increment
-    static int id;
+    static long id;
 
   public:
     // get a global unique name
     static std::string allocName();
+
+    // skip n names, so that names allocated by
+    // different processes do not collide
+    static void advance(long n) { id += n; }
+
+    // id of the next name
+    static long next() { return id; }
   };
 
   // allocate global unique name for path
   class PathNameAllocator {
   private:
-    static int id;
+    static long id;
 
   public:
     static std::string allocName();
+    static void advance(long n) { id += n; }
+    static long next() { return id; }
   };
 
   // allocte global unique name for block
   class BlockNameAllocator {
   private:
-    static int id;
+    static long id;
 
   public:
     static std::string allocName();
+    static void advance(long n) { id += n; }
+    static long next() { return id; }
   };
 }
 
@@ -0,0 +1,70 @@
+#ifndef LOOP_EXTRACTION_OMP_ANNOTATION_H
+#define LOOP_EXTRACTION_OMP_ANNOTATION_H
+
+#include "program.h"
+#include "callSummary.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // insert '#pragma omp parallel for' before loops whose iterations
+  // are independent
+  //
+  // a for loop in canonical form, e.g. 'for (i = 0; i < n; ++i)',
+  // is annotated if
+  // - it carries no dependence through arrays, see DependenceAnalysis
+  // - every scalar it carries is a reduction, i.e. all its updates are
+  //   's = s op e' with the same op and s is read nowhere else,
+  //   or it is never read and written in every iteration (lastprivate)
+  // - it has no break, return or goto, and calls only functions
+  //   that are summarized, see CallSummaries
+  // indices of inner loops declared outside are private, a loop with
+  // another induction variable declared outside isn't annotated
+  // only the outermost loop of a nest is annotated
+  class OmpAnnotation {
+  private:
+    CallSummaries& calls;
+
+    // loops annotated so far
+    std::set<SgStatement*> annotated;
+
+    // references of variables in constraints, updates and
+    // declarations of a loop and its inner loops
+    std::map<std::string, int> refs;
+
+    // values of scalars updated in a loop and its inner loops
+    std::map<std::string, std::vector<SgExpression*> > updates;
+
+    // variables declared in a loop and its inner loops
+    std::set<std::string> declared;
+
+    // count references of variables in an expression
+    static void countRefs(SgExpression* expr, std::map<std::string, int>& refs);
+
+    // operator of a reduction 's = s op e', e.g. '+', false if it isn't one
+    static bool getReductionOp(SgExpression* value, const std::string& name,
+                               std::string& op);
+
+    // whether a loop has no jumps out of it or calls of unknown functions
+    bool isStructured(SgForStatement* forStmt);
+
+    // collect references, updates and declarations of a loop and its inner loops
+    void collect(Loop* loop, std::set<Loop*>& visited);
+
+    // pragma of a loop, false if it can't be run in parallel
+    bool buildPragma(Loop* loop, SgForStatement* forStmt, std::string& pragma);
+
+  public:
+    OmpAnnotation(CallSummaries& c): calls(c) {}
+
+    // annotate a loop, or its inner loops if it can't be
+    // return number of annotated loops
+    int annotate(Loop* loop);
+  };
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef LOOP_EXTRACTION_OPTIONS_H
+#define LOOP_EXTRACTION_OPTIONS_H
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // options of loop extraction
+  // they are given on command line with prefix '-le:'
+  // e.g. -le:jobs=4
+  // and they are removed before arguments are passed to ROSE
+  class Options {
+  public:
+    // number of forked workers that extract functions of a file
+    // 1 means functions are extracted in this process
+    int jobs;
+
+    // parse, extract and release files one by one
+    // instead of parsing all files at once
+    bool stream;
+
+    // directory of cached ASTs, see AstCache
+    // empty means ASTs are not cached
+    // caching works file by file, so it implies stream
+    std::string cacheDir;
+
+    // keep updates of blocks and loop paths that are never read
+    // see LivenessAnalysis
+    bool keepDead;
+
+    // don't fuse adjacent blocks, see BlockCoalescing
+    bool noCoalesce;
+
+    // don't merge equivalent paths, see PathDeduplication
+    bool noDedup;
+
+    // extract identical functions once per run, e.g. static inline
+    // helpers of headers, see Fingerprint
+    bool dedupFunctions;
+
+    // summarize single-entry/single-exit regions of function bodies
+    // one after another instead of as one cross product of paths
+    bool regions;
+
+    // don't fork paths at branches, updates in a branch are guarded by
+    // its condition instead, and accesses of blocks, loops and functions
+    // are collected, see AccessAnalysis
+    bool fast;
+
+    // inputs sampled per function to find a witness of each path,
+    // 0 means no witnesses are searched for, see WitnessSampler
+    long witnesses;
+
+    // compute ranges of variables at the end of paths and at loop headers
+    // see RangeAnalysis
+    bool ranges;
+
+    // output format, 'json', 'smt2' or 'sqlite'
+    // see JsonPrinter, SmtPrinter and SqlitePrinter
+    std::string format;
+
+    // database written with format 'sqlite'
+    std::string db;
+
+    // layout of paths in JSON, 'flat' or 'tree', see TreePrinter
+    std::string layout;
+
+    // file of diagnostics as JSON lines, empty means stderr
+    // see Diagnostics
+    std::string diagFile;
+
+    // warnings written for each kind, the rest are only counted
+    int diagLimit;
+
+    // file of Chrome trace events, empty means no trace
+    // see Trace
+    std::string traceFile;
+
+    // annotate parallel loops with OpenMP pragmas and write
+    // the source next to each input, see OmpAnnotation
+    bool omp;
+
+    // output of perf report or gprof, see Profile
+    // empty means every function is extracted in full
+    std::string profile;
+
+    // percentage of samples from which a function is hot
+    // cold functions are extracted without the passes after extraction
+    double profileThreshold;
+
+    // skip cold functions instead of extracting them cheaply
+    bool profileOnly;
+
+    // patterns of functions to extract, see Selector
+    // empty means every function
+    std::vector<std::string> functions;
+
+    // patterns of source files to extract, see Selector
+    // empty means every file
+    std::vector<std::string> files;
+
+    // sections to print, e.g. 'paths', 'loops'
+    // empty means every section
+    std::set<std::string> sections;
+
+    Options(): jobs(1), stream(false), keepDead(false),
+               noCoalesce(false), noDedup(false), dedupFunctions(false), regions(false), fast(false), witnesses(0),
+               ranges(false),
+               format("json"), layout("flat"),
+               diagLimit(10), omp(false), profileThreshold(1.0), profileOnly(false) {}
+
+    // parse options of loop extraction and remove them from args
+    void parse(std::vector<std::string>& args);
+  };
+
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef LOOP_EXTRACTION_PATH_DEDUPLICATION_H
+#define LOOP_EXTRACTION_PATH_DEDUPLICATION_H
+
+#include "program.h"
+#include <string>
+
+namespace LE {
+
+  // merge paths that do the same thing under different constraints
+  //
+  // two paths of a function are equivalent if they run the same
+  // blocks and loops and return the same value; two paths of a loop
+  // are equivalent if they have the same updates, inner loops and
+  // break flag. equivalent paths are merged into one path whose
+  // constraint is the disjunction of their constraints
+  // paths of a function are only equivalent if they check all their
+  // constraints after the same step, see ConstraintList
+  class PathDeduplication {
+  private:
+    // printed form of everything but constraints of a path
+    static std::string fingerprint(Path* path);
+    static std::string fingerprint(LoopPath* path);
+
+    // conjunction of a constraint list, nullptr if list is empty
+    static SgExpression* conjunction(ConstraintList* cl);
+
+    // constraint list that holds if either of two lists holds
+    // checked after step steps
+    static ConstraintList* disjunction(ConstraintList* first, ConstraintList* second,
+                                       size_t step = 0);
+
+    // merge equivalent paths of a loop and its inner loops
+    static int deduplicate(Loop* loop);
+
+  public:
+    // merge equivalent paths of a function and of its loops
+    // return number of merged paths
+    static int deduplicate(Function* func);
+  };
+
+}
+
+#endif
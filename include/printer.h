@@ -2,28 +2,51 @@
 #define LOOP_EXTRACTION_PRINTER_H
 
 #include "program.h"
+#include <map>
 #include <ostream>
 #include <string>
 #include <set>
+#include <vector>
 
 namespace LE {
 
   class Printer {
   public:
     virtual void printProgram(std::ostream& os, Program* program, int indentLv = 0) = 0;
+    // print a program whose functions have been printed by printFunction
+    // e.g. in forked workers, see WorkerPool
+    virtual void printProgram(std::ostream& os, Program* program,
+                              const std::vector<std::string>& functions, int indentLv = 0) = 0;
+    virtual void printFunction(std::ostream& os, Function* func, int indentLv = 0) = 0;
     virtual void printFunctions(std::ostream& os, const std::set<Function*>& functions, int indentLv = 0) = 0;
     virtual void printPaths(std::ostream& os, const std::set<Path*>& paths, int indentLv = 0) = 0;
     virtual void printLoops(std::ostream& os, const std::set<Loop*>& loops, int indentLv = 0) = 0;
     virtual void printLoopPaths(std::ostream& os, const std::set<LoopPath*>& loopPath, int indentLv = 0) = 0;
     virtual void printExpression(std::ostream& os, SgExpression* expr);
 
+    // indentation level of functions within a printed program
+    virtual int getFunctionIndent() const { return 0; }
+
+    // sections to print, e.g. 'paths', 'loops', see Options::sections
+    // empty means every section
+    inline void setSections(const std::set<std::string>& s) { sections = s; }
+
     Printer(): indent("    ") {}
     virtual ~Printer() {};
 
   protected:
     std::string indent;
+    std::set<std::string> sections;
 
     std::string getIndent(int level);
+
+    // print an expression, or a part of one, in another notation
+    // return false to print it as infix, see printExpression
+    virtual bool printTerm(std::ostream& os, SgExpression* expr) { return false; }
+
+    inline bool hasSection(const std::string& name) const {
+      return sections.empty() || sections.count(name) > 0;
+    }
   };
 
   // // print result of loop extraction
@@ -61,32 +84,61 @@ namespace LE {
   // };
 
   class JsonPrinter: public Printer {
-  private:
+  protected:
     void printVarDecl(std::ostream& os, VariableTable* varTbl, int indentLv);
     void printVarInit(std::ostream& os, VariableTable* varTbl, int indentLv);
     void printVariable(std::ostream& os, Variable* var, int indentLv);
     void printCanBreak(std::ostream& os, bool canBreak, int indentLv);
     void printConstraints(std::ostream& os, ConstraintList* cl, int indentLv);
+    // 'constraint_steps': [ 0, 1 ], steps run before each constraint
+    void printConstraintSteps(std::ostream& os, ConstraintList* cl, int indentLv);
     void printFuncParam(std::ostream& os, const std::set<std::string>& params, int indentLv);
+    void printInvariantVars(std::ostream& os, const std::set<std::string>& vars, int indentLv);
+    // 'key': [ 'a', 'b' ]
+    void printNames(std::ostream& os, const std::string& key,
+                    const std::set<std::string>& names, int indentLv);
+    void printAccess(std::ostream& os, const Access& access, int indentLv);
+    void printAccesses(std::ostream& os, const std::map<std::string, Access>& accesses, int indentLv);
+    void printInvariantExprs(std::ostream& os, const std::vector<SgExpression*>& exprs, int indentLv);
+    void printDependences(std::ostream& os, const std::vector<Dependence>& deps, int indentLv);
+    void printCarriedScalars(std::ostream& os, const std::set<std::string>& vars, int indentLv);
+    void printParallel(std::ostream& os, bool parallel, int indentLv);
     void printReturnValue(std::ostream& os, SgExpression* retVal, int indentLv);
+    void printMergedPaths(std::ostream& os, int merged, int indentLv);
+    // inputs for which a path is taken, or 'none'
+    void printWitness(std::ostream& os, Path* path, int indentLv);
+    // 'ranges': { 'i': '[0, 100]' }, bounds may be 'inf' or '-inf'
+    void printRanges(std::ostream& os, const std::map<std::string, Interval>& ranges, int indentLv);
+    // ranges at the end of a path, or 'infeasible'
+    void printPathRanges(std::ostream& os, Path* path, int indentLv);
+    void printProfileWeight(std::ostream& os, double weight, int indentLv);
     void printPath(std::ostream& os, Path* path, int indentLv);
     void printPaths(std::ostream& os, const std::vector<std::string>& p, int indentLv);
     void printBlock(std::ostream& os, Block* block, int indentLv);
     void printBlocks(std::ostream& os, const std::set<Block*>& blocks, int indentLv);
     void printLoopPath(std::ostream& os, LoopPath* loopPath, int indentLv);
     void printLoopPath(std::ostream& os, const std::set<std::string>& innerLoops, VariableTable* varTbl, int indentLv);
+    void printLoopEntry(std::ostream& os, Loop* loop, int indentLv);
     void printLoop(std::ostream& os, Loop* loop, std::set<Loop*>& printed, int indentLv);
-    void printInnerLoops(std::ostream& os, const std::set<Loop*>& loops, std::set<Loop*>& printed, int indentLv);
-    void printFunction(std::ostream& os, Function* func, int indentLv);
+    void printFunctions(std::ostream& os, const std::vector<std::string>& functions, int indentLv);
+
+    // paths, blocks, loops and merged paths of a function or of one of its
+    // regions, each selected section is preceded by sep, which becomes ',\n'
+    void printScope(std::ostream& os, Function* scope, std::string& sep, int indentLv);
+    void printRegions(std::ostream& os, const std::vector<Function*>& regions, int indentLv);
     void printProgramName(std::ostream& os, const std::string& name, int indentLv);
 
   public:
     virtual void printProgram(std::ostream& os, Program* program, int indentLv = 0);
+    virtual void printProgram(std::ostream& os, Program* program,
+                              const std::vector<std::string>& functions, int indentLv = 0);
+    virtual void printFunction(std::ostream& os, Function* func, int indentLv = 0);
     virtual void printFunctions(std::ostream& os, const std::set<Function*>& functions, int indentLv = 0);
     virtual void printPaths(std::ostream& os, const std::set<Path*>& paths, int indentLv = 0);
     virtual void printLoops(std::ostream& os, const std::set<Loop*>& loops, int indentLv = 0);
     virtual void printLoopPaths(std::ostream& os, const std::set<LoopPath*>& paths, int indentLv = 0);
     virtual void printExpression(std::ostream& os, SgExpression* expr);
+    virtual int getFunctionIndent() const { return 2; }
 
     virtual ~JsonPrinter() {}
   };
@@ -0,0 +1,44 @@
+#ifndef LOOP_EXTRACTION_PROFILE_H
+#define LOOP_EXTRACTION_PROFILE_H
+
+#include "rose.h"
+#include <istream>
+#include <map>
+#include <string>
+
+namespace LE {
+
+  // share of samples (or of time) of each function in a profile
+  //
+  // a profile is the text output of 'perf report --stdio', e.g.
+  //   45.23%  prog  prog  [.] compute
+  // or the flat profile of gprof, e.g.
+  //   33.34      0.02     0.02        7     2.86     2.86  compute
+  // symbols are matched with functions by their unqualified name,
+  // without parameters or suffixes of compiler clones,
+  // e.g. 'ns::compute(int) [clone .constprop.0]' -> 'compute'
+  class Profile {
+  private:
+    // percentage by function name
+    std::map<std::string, double> weights;
+
+    // read lines of 'perf report'
+    void readPerf(std::istream& is);
+
+    // read the flat profile of gprof
+    void readGprof(std::istream& is);
+
+  public:
+    // name of the function a symbol refers to
+    static std::string normalize(const std::string& symbol);
+
+    // load a profile, return false if the file can't be read
+    bool load(const std::string& file);
+
+    // percentage of a function, 0 if it is not in the profile
+    double getWeight(SgFunctionDeclaration* funcDecl) const;
+  };
+
+}
+
+#endif
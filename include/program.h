@@ -6,6 +6,7 @@
 #include <set>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace LE {
 
@@ -15,42 +16,100 @@ namespace LE {
 
   // a variable consists of a name, a value
   // it belongs to a variable table
+  // expressions of a variable are not owned, they are shared with other
+  // variables, constraints and clones of the AST
   class Variable {
   private:
+    friend class VariableTable;
+
+    // number of variable tables holding this variable
+    int refs;
+
     std::string name;
     VariantT type;
     SgExpression* initValue;
     SgExpression* value;
 
+    // written reference, e.g. 'arr[i]', with its subscripts
+    // in terms of values before the update, nullptr if unknown
+    SgExpression* target;
+
   public:
     Variable(VariantT ty, const std::string &n, SgExpression* v):
-      name(n), type(ty), initValue(v), value(v) {}
+      refs(0), name(n), type(ty), initValue(v), value(v), target(nullptr) {}
 
-    Variable(const std::string &n, SgExpression* v):
-      name(n), value(v) {}
+    // an update, its type is unknown, i.e. V_SgNode, and it has no initial value
+    Variable(const std::string &n, SgExpression* v, SgExpression* t = nullptr):
+      refs(0), name(n), type(V_SgNode), initValue(nullptr), value(v), target(t) {}
 
     inline std::string getName() { return name; }
     inline SgExpression* getValue() { return value; }
     inline SgExpression* getInitValue() { return initValue; }
+    inline SgExpression* getTarget() { return target; }
     inline VariantT getType() { return type;}
   };
 
+  // a dependence between two array accesses of different iterations
+  // distances and directions have one entry per loop of the nest,
+  // starting from the loop that owns the dependence
+  // see DependenceAnalysis
+  struct Dependence {
+    // 'flow', 'anti', 'output', or 'unknown' for writes through pointers
+    // and writes of bases that may alias another base
+    std::string kind;
+    std::string array;
+
+    // accesses in the earlier and the later iteration
+    std::string source;
+    std::string sink;
+
+    // '*' if unknown
+    std::vector<std::string> distance;
+
+    // '<', '=', '>' or '*'
+    std::vector<std::string> direction;
+
+    // loop of the nest carrying the dependence, starting from 1
+    int level;
+  };
+
+  // variables a block, a loop or a function may read and may modify
+  // arrays and pointers by their base name, see AccessAnalysis
+  struct Access {
+    std::set<std::string> mayRead;
+    std::set<std::string> mayModify;
+  };
+
+  // values a variable may have, bounds are infinite if unknown
+  // see RangeAnalysis
+  struct Interval {
+    double lo;
+    double hi;
+  };
+
   // a variable table is a set of variables
+  // tables share variables with their clones, a variable is deleted
+  // with the last table holding it
   class VariableTable {
   private:
     std::map<std::string, Variable*> table;
 
+    // drop a variable from a table, delete it if no other table holds it
+    static void release(Variable* var);
+
   public:
     VariableTable() {}
+    ~VariableTable();
+    VariableTable(const VariableTable&) = delete;
+    VariableTable& operator=(const VariableTable&) = delete;
 
     inline void addVariable(Variable* var) {
       assert(var != nullptr);
-      table[var->getName()] = var;
+      addVariable(var->getName(), var);
     }
 
-    inline void addVariable(const std::string &name, Variable* var) {
-      table[name] = var;
-    }
+    void addVariable(const std::string &name, Variable* var);
+    void removeVariable(const std::string &name);
 
     Variable* getVariable(const std::string &name) const;
     VariableTable* clone() const;
@@ -85,12 +144,14 @@ namespace LE {
   public:
     LoopPath(VariableTable* tbl, ConstraintList* cl, bool b):
       varTbl(tbl), constraintList(cl), canBreak(b) {}
+    ~LoopPath() { delete varTbl; delete constraintList; }
 
     //inline Loop* getParent() { return parent; }
     inline VariableTable* getVariableTable() { return varTbl; }
     inline bool canBreakLoop() const { return canBreak; }
     inline void setCanBreak(bool b) { canBreak = b; }
     inline ConstraintList* getConstraintList() { return constraintList; }
+    inline void setConstraintList(ConstraintList* cl) { constraintList = cl; }
     inline void addInnerLoop(const std::string& loop) { innerLoops.insert(loop); }
     inline const std::set<std::string>& getInnerLoops() const { return innerLoops; }
     inline void addConstraint(SgExpression* c) { constraintList->addConstraint(c); }
@@ -120,14 +181,66 @@ namespace LE {
     // paths of loop
     std::set<LoopPath*> paths;
 
+    // variables whose values do not change across iterations
+    // see InvariantAnalysis
+    std::set<std::string> invariantVars;
+
+    // largest subexpressions of constraints and updates
+    // whose values do not change across iterations
+    std::vector<SgExpression*> invariantExprs;
+
+    // number of paths merged into equivalent paths
+    // see PathDeduplication
+    int mergedPaths;
+
+    // loop-carried dependences through arrays, see DependenceAnalysis
+    std::vector<Dependence> dependences;
+
+    // scalars carrying values from one iteration to the next
+    std::set<std::string> carriedScalars;
+
+    // whether iterations of the loop are independent
+    bool parallel;
+
+    // variables every iteration adds the same constant to, and their steps
+    std::map<std::string, long> inductionVars;
+
+    // ranges of variables at the header of the loop, see RangeAnalysis
+    std::map<std::string, Interval> ranges;
+
+    // statement of the loop in the AST
+    SgStatement* stmt;
+
   public:
-    Loop(const std::string& n, VariableTable* vt): name(n), varTbl(vt) {}
+    Loop(const std::string& n, VariableTable* vt):
+      name(n), varTbl(vt), mergedPaths(0), parallel(false), stmt(nullptr) {}
+    // a loop owns its paths and inner loops
+    ~Loop();
     inline void addPath(LoopPath* p) {paths.insert(p);}
+    inline void removePath(LoopPath* p) { paths.erase(p); }
+    inline void addMergedPaths(int n) { mergedPaths += n; }
+    inline int getMergedPaths() const { return mergedPaths; }
     inline std::string getName() {return name;}
     inline VariableTable* getVariableTable() { return varTbl; }
     void addInnerLoop(Loop* loop);
     inline const std::set<Loop*>& getInnerLoops() const { return innerLoops; }
     inline std::set<LoopPath*> getPaths() { return paths; }
+    inline void setInvariantVars(const std::set<std::string>& vars) { invariantVars = vars; }
+    inline const std::set<std::string>& getInvariantVars() const { return invariantVars; }
+    inline void setInvariantExprs(const std::vector<SgExpression*>& exprs) { invariantExprs = exprs; }
+    inline const std::vector<SgExpression*>& getInvariantExprs() const { return invariantExprs; }
+    inline void setDependences(const std::vector<Dependence>& deps) { dependences = deps; }
+    inline const std::vector<Dependence>& getDependences() const { return dependences; }
+    inline void setCarriedScalars(const std::set<std::string>& vars) { carriedScalars = vars; }
+    inline const std::set<std::string>& getCarriedScalars() const { return carriedScalars; }
+    inline void setParallel(bool b) { parallel = b; }
+    inline bool isParallel() const { return parallel; }
+    inline void setInductionVars(const std::map<std::string, long>& vars) { inductionVars = vars; }
+    inline const std::map<std::string, long>& getInductionVars() const { return inductionVars; }
+    inline void setRanges(const std::map<std::string, Interval>& r) { ranges = r; }
+    inline const std::map<std::string, Interval>& getRanges() const { return ranges; }
+    inline void setStatement(SgStatement* s) { stmt = s; }
+    inline SgStatement* getStatement() const { return stmt; }
 
     typedef std::set<LoopPath*>::iterator iterator;
     typedef std::set<LoopPath*>::const_iterator const_iterator;
@@ -155,6 +268,7 @@ namespace LE {
 
   public:
     Block(const std::string& n, VariableTable* vt): name(n), varTbl(vt) {}
+    ~Block() { delete varTbl; }
 
     inline VariableTable* getVariableTable() { return varTbl; }
     inline std::string getName() { return name; }
@@ -170,13 +284,30 @@ namespace LE {
     SgExpression* retVal;
     bool isReturn;
 
+    // values of inputs for which the path is taken, see WitnessSampler
+    // a witness is searched for with -le:witnesses only
+    std::map<std::string, double> witness;
+    bool witnessSearched;
+    bool witnessFound;
+
+    // ranges of variables at the end of the path, see RangeAnalysis
+    // ranges are computed with -le:ranges only
+    std::map<std::string, Interval> ranges;
+    bool rangesAnalyzed;
+    bool infeasible;
+
   public:
     Path(const std::string& n, ConstraintList* cl, SgExpression* rv = nullptr):
-      name(n), constraintList(cl), retVal(rv), isReturn(false) {}
+      name(n), constraintList(cl), retVal(rv), isReturn(false),
+      witnessSearched(false), witnessFound(false),
+      rangesAnalyzed(false), infeasible(false) {}
 
     Path(const std::string& n, ConstraintList* cl,
         const std::vector<std::string>& p, SgExpression* rv, bool ret):
-          name(n), constraintList(cl), paths(p), retVal(rv), isReturn(ret) {}
+          name(n), constraintList(cl), paths(p), retVal(rv), isReturn(ret),
+          witnessSearched(false), witnessFound(false),
+          rangesAnalyzed(false), infeasible(false) {}
+    ~Path() { delete constraintList; }
 
     inline std::string getName() { return name; }
     inline SgExpression* getReturnValue() { return retVal; }
@@ -185,8 +316,29 @@ namespace LE {
     inline void setPathReturn(bool b) { isReturn = b; }
     inline void addPath(const std::string& p) { paths.push_back(p); }
     inline std::vector<std::string> getPaths() { return paths; }
-    inline void addConstraint(SgExpression* e) { constraintList->addConstraint(e); }
+    inline void setPaths(const std::vector<std::string>& p) { paths = p; }
+    // the constraint is checked after the steps the path has so far
+    inline void addConstraint(SgExpression* e) { constraintList->addConstraint(e, paths.size()); }
     inline ConstraintList* getConstraints() { return constraintList; }
+    inline void setConstraints(ConstraintList* cl) { constraintList = cl; }
+    inline void setWitness(const std::map<std::string, double>& w) {
+      witness = w;
+      witnessSearched = witnessFound = true;
+    }
+    inline void setNoWitness() { witnessSearched = true; witnessFound = false; }
+    inline bool isWitnessSearched() const { return witnessSearched; }
+    inline bool hasWitness() const { return witnessFound; }
+    inline const std::map<std::string, double>& getWitness() const { return witness; }
+    inline void setRanges(const std::map<std::string, Interval>& r) {
+      ranges = r;
+      rangesAnalyzed = true;
+      infeasible = false;
+    }
+    // no input satisfies the constraints of the path
+    inline void setInfeasible() { ranges.clear(); rangesAnalyzed = infeasible = true; }
+    inline bool isRangesAnalyzed() const { return rangesAnalyzed; }
+    inline bool isInfeasible() const { return infeasible; }
+    inline const std::map<std::string, Interval>& getRanges() const { return ranges; }
 
 
     Path* clone();
@@ -206,8 +358,33 @@ namespace LE {
     std::set<Loop*> loops;
     std::set<Block*> blocks;
 
+    // number of paths merged into equivalent paths
+    // see PathDeduplication
+    int mergedPaths;
+
+    // percentage of samples in the profile, negative if there is none
+    // see Profile
+    double profileWeight;
+
+    // 'file:function' extracted first with the same fingerprint,
+    // empty if this function is extracted, see Fingerprint
+    std::string sameAs;
+
+    // single-entry/single-exit regions of the body in order, see -le:regions
+    // each region has its own paths, blocks and loops, the function none
+    // a run of the function runs a path of each region in turn
+    std::vector<Function*> regions;
+
+    // accesses of the function and of its blocks and loops by name
+    // empty unless -le:fast, see AccessAnalysis
+    Access access;
+    std::map<std::string, Access> accesses;
+
   public:
-    Function(VariableTable* vt): varTbl(vt) {}
+    Function(VariableTable* vt): varTbl(vt), mergedPaths(0), profileWeight(-1) {}
+    // a function owns its paths, loops, blocks and regions
+    // regions share the variable table of their function
+    ~Function();
 
     inline std::string getName() { return name; }
     inline void setName(const std::string& n) { name = n; }
@@ -216,12 +393,33 @@ namespace LE {
     inline VariableTable* getVariableTable() { return varTbl; }
     inline std::set<std::string> getParams() { return parameters; }
     inline void addPath(Path* p) { paths.insert(p); }
+    inline void removePath(Path* p) { paths.erase(p); }
     inline std::set<Path*> getPaths() { return paths; }
+    inline void addMergedPaths(int n) { mergedPaths += n; }
+    inline int getMergedPaths() const { return mergedPaths; }
+    inline void setProfileWeight(double w) { profileWeight = w; }
+    inline double getProfileWeight() const { return profileWeight; }
+    inline void setSameAs(const std::string& ref) { sameAs = ref; }
+    inline const std::string& getSameAs() const { return sameAs; }
+    inline void addRegion(Function* region) { regions.push_back(region); }
+    inline const std::vector<Function*>& getRegions() const { return regions; }
+    // regions if there are some, otherwise the function itself,
+    // paths, blocks and loops are in these scopes
+    inline std::vector<Function*> getScopes() {
+      return regions.empty() ? std::vector<Function*>(1, this) : regions;
+    }
+    inline Access& getAccess() { return access; }
+    inline std::map<std::string, Access>& getAccesses() { return accesses; }
     inline void addLoop(Loop* l) { loops.insert(l); }
     inline void addBlock(Block* b) { blocks.insert(b); }
+    inline void removeBlock(Block* b) { blocks.erase(b); }
     inline std::set<Block*> getBlocks() { return blocks; }
     inline std::set<Loop*> getLoops() { return loops; }
 
+    // base names of variables updated by blocks and loops of the function
+    // and its regions, e.g. 'a' for 'a[i] = 0'
+    std::set<std::string> getUpdated();
+
     // clone a function with the same paths as origin function except
     // paths that have been returned
     Function* cloneNotReturnPaths();
@@ -240,6 +438,7 @@ namespace LE {
   public:
     Program(const std::string& n, VariableTable* vt):
       name(n), varTbl(vt) {}
+    ~Program();
 
     inline VariableTable* getVariableTable() { return varTbl; }
     inline std::string getName() { return name; }
@@ -0,0 +1,96 @@
+#ifndef LOOP_EXTRACTION_RANGE_H
+#define LOOP_EXTRACTION_RANGE_H
+
+#include "program.h"
+#include <map>
+#include <set>
+#include <string>
+
+namespace LE {
+
+  // compute ranges of variables at the end of each path and at the
+  // header of each loop, by abstract interpretation over intervals
+  //
+  // parameters start with the range of their type, declared variables
+  // with the range of their initial value unless it reads an updated
+  // variable, constraints of the form
+  // 'x < e', 'x == e', '!c', 'a && b', 'a || b' narrow the ranges,
+  // and updates are evaluated over intervals
+  // a loop header joins the entry with the ends of the paths that
+  // don't break, after widenDelay iterations bounds still growing are
+  // widened to infinity, and one more iteration narrows them again,
+  // e.g. 'for (i = 0; i < 100; ++i)' has 'i' in [0, 100] at its header
+  // constraints of a function path narrow the ranges after the steps
+  // before them, those of a loop path at the header, see ConstraintList
+  // a path whose constraints contradict the ranges is infeasible
+  // values are mathematical, overflow is not modelled, as in Evaluator,
+  // and a write through a pointer forgets every range
+  class RangeAnalysis {
+  private:
+    // ranges at a point of the function, a variable without range is
+    // unbounded, an unreachable point has no ranges
+    struct State {
+      bool reachable;
+      std::map<std::string, Interval> vars;
+
+      State(bool r = true): reachable(r) {}
+    };
+
+    // iterations of a loop before its bounds are widened
+    static const int widenDelay = 2;
+
+    // variables of integral type, their bounds are whole numbers
+    std::set<std::string> integral;
+
+    // ranges at loop headers, joined over the paths entering them
+    std::map<Loop*, State> headers;
+
+    // variables updated by blocks and loops of the function, see
+    // Function::getUpdated
+    std::set<std::string> updated;
+
+    static Interval top();
+    static bool isTop(const Interval& range);
+    static Interval hull(const Interval& a, const Interval& b);
+    static State join(const State& a, const State& b);
+    static State widen(const State& before, const State& after);
+    static bool same(const State& a, const State& b);
+    // ranges of a state that are bounded
+    static std::map<std::string, Interval> bounded(const State& state);
+
+    // save the value of an assignment, integral variables are truncated
+    void assign(State& state, const std::string& name, Interval range);
+    // intersect the range of a variable, unreachable if empty
+    void narrow(State& state, const std::string& name, double lo, double hi);
+
+    // value of an operator for the ranges of its operands
+    static Interval applyBinary(SgBinaryOp* binOp, const Interval& lhs, const Interval& rhs);
+    static Interval applyUnary(SgUnaryOp* unaryOp, const Interval& operand);
+    Interval evaluate(SgExpression* expr, const State& state);
+    // whether 'lhs op rhs' may hold for values in the ranges
+    static bool mayHold(VariantT op, const Interval& lhs, const Interval& rhs);
+    // ranges for which a constraint holds, or doesn't hold
+    State refine(const State& state, SgExpression* constraint, bool holds);
+    // updates of a block or a loop path, made all at once
+    State apply(const State& state, VariableTable* varTbl);
+
+    // run each path of a loop once from its header
+    // paths that break the loop are joined into exit, others into back
+    void iterate(Loop* loop, const State& header, State& back, State& exit, bool record);
+    // ranges at the exit of a loop, headers are recorded if record is set
+    State analyzeLoop(Loop* loop, const State& entry, bool record);
+
+    void collectIntegral(VariableTable* varTbl);
+
+    // range of the initial value of a declaration, declarations have no
+    // position, so one reading an updated variable is unbounded
+    Interval initialRange(Variable* var, const State& state);
+
+  public:
+    // results are saved in paths and loops, see Path::getRanges
+    static void analyze(Function* func);
+  };
+
+}
+
+#endif
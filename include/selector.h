@@ -0,0 +1,44 @@
+#ifndef LOOP_EXTRACTION_SELECTOR_H
+#define LOOP_EXTRACTION_SELECTOR_H
+
+#include "options.h"
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // select functions and files to extract
+  // by patterns given with -le:function and -le:file
+  //
+  // a pattern is a glob, e.g. 'kernel_*', that must match the whole name,
+  // or a regular expression between slashes, e.g. '/^k[0-9]+$/',
+  // that may match a part of it
+  // a file is selected if its path or its name without directories matches
+  class Selector {
+  private:
+    struct Pattern {
+      std::string glob;
+      bool isRegex;
+      std::regex regex;
+    };
+
+    std::vector<Pattern> functions;
+    std::vector<Pattern> files;
+
+    static std::vector<Pattern> compile(const std::vector<std::string>& patterns);
+
+    // whether name matches any pattern, true if there is no pattern
+    static bool matches(const std::vector<Pattern>& patterns, const std::string& name);
+
+  public:
+    Selector() {}
+    Selector(const Options& options);
+
+    bool selectsFunction(const std::string& name) const;
+    bool selectsFile(const std::string& path) const;
+  };
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef LOOP_EXTRACTION_SMT_PRINTER_H
+#define LOOP_EXTRACTION_SMT_PRINTER_H
+
+#include "printer.h"
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // print constraints of paths as SMT-LIB2 queries
+  //
+  // every function (and every loop) is a (push)/(pop) scope
+  // its paths are arranged as a tree of constraints, so that a
+  // prefix shared by several paths is asserted only once and
+  // a solver checks the paths incrementally, e.g.
+  //   (push 1)
+  //   (assert (> |n| 0))
+  //   (echo "path1")
+  //   (check-sat)
+  //   (pop 1)
+  class SmtPrinter: public Printer {
+  private:
+    enum Sort { SORT_INT, SORT_REAL, SORT_BOOL };
+
+    // a translated term and its sort
+    struct Term {
+      std::string text;
+      Sort sort;
+    };
+
+    // tree of constraints, children are keyed by their term
+    // and ends are the names of paths
+    typedef ConstraintTree<std::string> Node;
+
+    // sorts of global variables and of variables in current scope
+    std::map<std::string, Sort> globals;
+    std::map<std::string, Sort> sorts;
+
+    // variables referenced by translated constraints
+    std::set<std::string> referenced;
+
+    // blocks and loops of the function being printed by name,
+    // steps of its paths are looked up here
+    std::map<std::string, Block*> blocks;
+    std::map<std::string, Loop*> loops;
+
+    static Sort toSort(VariantT type);
+    static std::string sortName(Sort sort);
+    static std::string quote(const std::string& name);
+
+    // convert a term to another sort
+    static std::string toBool(const Term& term);
+    static std::string toNumber(const Term& term, Sort sort);
+
+    // translate an expression, return false if SMT-LIB can't express it
+    bool translate(SgExpression* expr, Term& term);
+
+    // translate a constraint into a boolean term
+    bool translateConstraint(SgExpression* expr, std::string& text);
+
+    // declare variables of a table not declared yet in this scope
+    void declareVariables(std::ostream& os, VariableTable* varTbl,
+                          std::set<std::string>& declared, int indentLv);
+
+    // declare referenced variables not declared yet in this scope
+    void declareReferenced(std::ostream& os, std::set<std::string>& declared, int indentLv);
+
+    // add a path to a tree of constraints
+    // a constraint after steps of a function path is asserted over the
+    // values the blocks before it computed from entry values
+    // constraints SMT-LIB can't express, or reading variables written by
+    // a loop or through a pointer before them, are dropped
+    void addToTree(Node* root, ConstraintList* cl, const std::string& name,
+                   Path* path = nullptr);
+
+    void setGlobals(VariableTable* varTbl);
+    void printTree(std::ostream& os, Node* node, int indentLv);
+    void printLoop(std::ostream& os, Loop* loop, std::set<std::string> declared, int indentLv);
+
+    // expressions SMT-LIB can express are printed as terms,
+    // the rest as infix with terms inside
+    virtual bool printTerm(std::ostream& os, SgExpression* expr);
+
+  public:
+    virtual void printProgram(std::ostream& os, Program* program, int indentLv = 0);
+    virtual void printProgram(std::ostream& os, Program* program,
+                              const std::vector<std::string>& functions, int indentLv = 0);
+    virtual void printFunction(std::ostream& os, Function* func, int indentLv = 0);
+    virtual void printFunctions(std::ostream& os, const std::set<Function*>& functions, int indentLv = 0);
+    virtual void printPaths(std::ostream& os, const std::set<Path*>& paths, int indentLv = 0);
+    virtual void printLoops(std::ostream& os, const std::set<Loop*>& loops, int indentLv = 0);
+    virtual void printLoopPaths(std::ostream& os, const std::set<LoopPath*>& paths, int indentLv = 0);
+
+    // globals gives sorts of global variables when functions are
+    // printed without their program, e.g. in forked workers
+    SmtPrinter(VariableTable* globals = nullptr);
+    virtual ~SmtPrinter() {}
+  };
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef LOOP_EXTRACTION_SQLITE_PRINTER_H
+#define LOOP_EXTRACTION_SQLITE_PRINTER_H
+
+#include "printer.h"
+#include <sqlite3.h>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // write programs into a SQLite database instead of printing them
+  //
+  // tables are normalized, every row refers to its owner by id:
+  //   programs, functions, params, variables,
+  //   paths, path_steps, blocks, loops, loop_paths, inner_loops,
+  //   constraints, updates, accesses, witnesses, ranges
+  // a constraint belongs to a path or a loop path, an update to
+  // a block or a loop path, the other id is NULL
+  // paths, blocks and loops of a function split by -le:regions
+  // have the name of their region, NULL otherwise
+  // e.g. loops updating 'x' under a constraint on 'n':
+  //   SELECT DISTINCT l.name FROM loops l
+  //     JOIN loop_paths lp ON lp.loop_id = l.id
+  //     JOIN updates u ON u.loop_path_id = lp.id
+  //     JOIN constraints c ON c.loop_path_id = lp.id
+  //   WHERE u.variable = 'x' AND c.text LIKE '%n%';
+  //
+  // the database is appended to, so a corpus can be extracted
+  // file by file into one database
+  // rows are inserted in transactions of batchSize rows
+  class SqlitePrinter: public Printer {
+  private:
+    // a value bound to a parameter of a statement
+    struct Value {
+      enum Kind { NONE, INTEGER, REAL, TEXT } kind;
+      long long integer;
+      double real;
+      std::string text;
+
+      Value(): kind(NONE), integer(0), real(0) {}
+      Value(int i): kind(INTEGER), integer(i), real(0) {}
+      Value(long long i): kind(INTEGER), integer(i), real(0) {}
+      Value(double d): kind(REAL), integer(0), real(d) {}
+      Value(const std::string& s): kind(TEXT), integer(0), real(0), text(s) {}
+      Value(const char* s): kind(TEXT), integer(0), real(0), text(s) {}
+    };
+
+    static const int batchSize = 10000;
+
+    std::string file;
+    sqlite3* db;
+
+    // prepared statements by their SQL
+    std::map<const char*, sqlite3_stmt*> statements;
+
+    // rows inserted in the open transaction
+    int rows;
+
+    // owners of rows inserted by printPaths, printLoops, ...
+    // 0 stands for none
+    long long programId;
+    long long functionId;
+    long long loopId;
+    // name of the region printed, empty if the function isn't split
+    std::string region;
+
+    // execute SQL without result, e.g. the schema
+    void execute(const char* sql);
+
+    // insert a row, return its id
+    long long insert(const char* sql, const std::vector<Value>& values);
+
+    // NULL for id 0
+    static Value idOrNull(long long id);
+
+    std::string expressionText(SgExpression* expr);
+
+    void insertVariables(VariableTable* varTbl, long long funcId, long long loopId);
+    void insertConstraints(ConstraintList* cl, long long pathId, long long loopPathId);
+    void insertUpdates(VariableTable* varTbl, long long blockId, long long loopPathId);
+    void insertAccess(const Access& access, const Value& element);
+    void insertRanges(const std::map<std::string, Interval>& ranges, long long pathId, long long loopId);
+    long long insertLoop(Loop* loop, long long outerId);
+    void insertScope(Function* scope);
+
+  public:
+    virtual void printProgram(std::ostream& os, Program* program, int indentLv = 0);
+    virtual void printProgram(std::ostream& os, Program* program,
+                              const std::vector<std::string>& functions, int indentLv = 0);
+    virtual void printFunction(std::ostream& os, Function* func, int indentLv = 0);
+    virtual void printFunctions(std::ostream& os, const std::set<Function*>& functions, int indentLv = 0);
+    virtual void printPaths(std::ostream& os, const std::set<Path*>& paths, int indentLv = 0);
+    virtual void printLoops(std::ostream& os, const std::set<Loop*>& loops, int indentLv = 0);
+    virtual void printLoopPaths(std::ostream& os, const std::set<LoopPath*>& paths, int indentLv = 0);
+
+    // open the database, create tables that don't exist yet
+    SqlitePrinter(const std::string& file);
+    // commit the open transaction and close the database
+    virtual ~SqlitePrinter();
+  };
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef LOOP_EXTRACTION_TRACE_H
+#define LOOP_EXTRACTION_TRACE_H
+
+#include <string>
+
+namespace LE {
+
+  // timeline of extraction as Chrome trace events
+  //
+  // a span is written when it ends, as a complete event with its start
+  // and duration in microseconds, e.g.
+  //   {"name": "foo", "cat": "function", "ph": "X", "ts": 1200, "dur": 35,
+  //    "pid": 7, "tid": 7, "args": {"location": "test.c:3"}},
+  // each event is one write to a file opened for appending, so forked
+  // workers share the file with parent and show up as its threads
+  // the file can be opened in chrome://tracing or Perfetto
+  class Trace {
+  public:
+    // write events to file, empty file means no trace
+    static void configure(const std::string& file);
+
+    static bool isEnabled();
+
+    // microseconds since configure
+    static long now();
+
+    // write a span from begin to end
+    // arg is printed as args[argName] unless argName is empty
+    static void span(const char* category, const std::string& name, long begin, long end,
+                     const char* argName, const std::string& arg);
+
+    // name the thread of this process, e.g. 'worker 2'
+    static void nameThread(const std::string& name);
+  };
+
+  // a span from construction to destruction, nothing if trace is disabled
+  class TraceScope {
+  private:
+    const char* category;
+    std::string name;
+    const char* argName;
+    std::string arg;
+    long begin;
+
+  public:
+    TraceScope(const char* category, const std::string& name,
+               const char* argName = "", const std::string& arg = "");
+    ~TraceScope();
+  };
+
+}
+
+#endif
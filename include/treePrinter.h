@@ -0,0 +1,56 @@
+#ifndef LOOP_EXTRACTION_TREE_PRINTER_H
+#define LOOP_EXTRACTION_TREE_PRINTER_H
+
+#include "printer.h"
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // print paths of functions and loops as decision trees
+  // instead of a flat list of constraint conjunctions
+  //
+  // paths are arranged in a tree keyed by their constraints,
+  // a condition and its negation (forked at the same if) become
+  // one 'if'/'then'/'else' node, e.g.
+  //   'decision_tree': {
+  //       'if': '(n > 0)',
+  //       'then': { 'name': 'path1', 'path': [ '{loop1}' ], 'return': 's' },
+  //       'else': { 'name': 'path2', 'path': [], 'return': '0' }
+  //   }
+  // a node with several alternatives, e.g. unpaired conditions
+  // of merged paths, lists them in 'cases'
+  // a condition checked after steps of the path reads the values they
+  // computed, its node names the last of them, e.g. 'after': 'block1',
+  // and equal conditions checked after different steps are different nodes
+  class TreePrinter: public JsonPrinter {
+  private:
+    template <class T>
+    using Node = ConstraintTree<T*>;
+
+    // keys are conditions, followed by a newline and the step they are
+    // checked after if it isn't the start, steps are the names of the
+    // blocks and loops of the path
+    template <class T>
+    void addToTree(Node<T>* root, ConstraintList* cl, T* end,
+                   const std::vector<std::string>& steps);
+
+    template <class T>
+    void printNode(std::ostream& os, Node<T>* node, int indentLv);
+
+    void printLeaf(std::ostream& os, Path* path, int indentLv);
+    void printLeaf(std::ostream& os, LoopPath* loopPath, int indentLv);
+
+  public:
+    virtual void printPaths(std::ostream& os, const std::set<Path*>& paths, int indentLv = 0);
+    virtual void printLoopPaths(std::ostream& os, const std::set<LoopPath*>& paths, int indentLv = 0);
+
+    virtual ~TreePrinter() {}
+  };
+
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef LOOP_EXTRACTION_WITNESS_H
+#define LOOP_EXTRACTION_WITNESS_H
+
+#include "program.h"
+#include <vector>
+
+namespace LE {
+
+  // find inputs for which each path is taken
+  //
+  // inputs are the parameters, globals and locals declared without
+  // initial value, they are sampled at random and the function is
+  // evaluated over batches of samples with the bytecode of Evaluator,
+  // so a witness takes its path, constraints checked in path order
+  // half of the values are taken from the constants of the constraints
+  // and their neighbours (c - 1, c + 1, -c), as branches mostly compare
+  // inputs with constants, the others are uniform around them
+  // sampling is seeded by the name of the function, so witnesses are
+  // the same in every run
+  // a path without witness may still be feasible, its constraints are
+  // just too narrow for the samples, see Path::isWitnessSearched
+  class WitnessSampler {
+  private:
+    // samples evaluated at once
+    static const size_t chunkSize = 4096;
+
+    // constants of the constraints of paths, their neighbours, 0, 1 and -1
+    static std::vector<double> collectConstants(Function* func);
+
+  public:
+    // sample inputs of a function until every path has a witness
+    // or samples inputs have been tried
+    // functions Evaluator can't compile are skipped with a warning
+    static void sample(Function* func, long samples);
+  };
+
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef LOOP_EXTRACTION_WORKER_POOL_H
+#define LOOP_EXTRACTION_WORKER_POOL_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  // run tasks in forked worker processes
+  // workers see memory of the parent (e.g. the parsed AST)
+  // through copy-on-write, so no code needs to be thread-safe
+  //
+  // output of a task is written to an ostream in the worker
+  // and sent back to the parent through a pipe
+  class WorkerPool {
+  private:
+    // number of workers to fork
+    int workers;
+
+  public:
+    // a task gets its index and a stream to write its output
+    typedef std::function<void(int, std::ostream&)> Task;
+
+    WorkerPool(int n): workers(n) {}
+
+    // run tasks 0 .. nTasks - 1 and return their outputs in task order
+    // worker k runs tasks k, k + workers, k + 2 * workers ...
+    // tasks that no worker reported (e.g. fork failed or worker crashed)
+    // are run in the parent
+    std::vector<std::string> run(int nTasks, const Task& task);
+  };
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include "access.h"
+#include "astHelper.h"
+
+namespace LE {
+
+  void AccessAnalysis::addReads(SgExpression* expr, Access& access) {
+    ASTHelper::collectVarNames(expr, access.mayRead);
+  }
+
+  void AccessAnalysis::addUpdates(VariableTable* varTbl, Access& access) {
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      access.mayModify.insert(ASTHelper::getBaseName(it->first));
+      addReads(it->second->getValue(), access);
+
+      // 'arr[i]' reads 'i', '*p' reads 'p', but 'arr' is only written
+      SgExpression* target = it->second->getTarget();
+      while (SgPntrArrRefExp* arrRef = dynamic_cast<SgPntrArrRefExp*>(target)) {
+        addReads(arrRef->get_rhs_operand(), access);
+        target = arrRef->get_lhs_operand();
+      }
+      if (target != nullptr && dynamic_cast<SgVarRefExp*>(target) == nullptr) {
+        addReads(target, access);
+      }
+    }
+  }
+
+  void AccessAnalysis::addAll(const Access& from, Access& to) {
+    to.mayRead.insert(from.mayRead.begin(), from.mayRead.end());
+    to.mayModify.insert(from.mayModify.begin(), from.mayModify.end());
+  }
+
+  const Access& AccessAnalysis::analyzeLoop(Loop* loop) {
+    auto iter = loopAccesses.find(loop);
+    if (iter != loopAccesses.end()) return iter->second;
+
+    Access& access = loopAccesses[loop];
+    VariableTable* decls = loop->getVariableTable();
+    for (auto it = decls->begin(), ie = decls->end(); it != ie; ++it) {
+      access.mayModify.insert(it->first);
+      addReads(it->second->getInitValue(), access);
+    }
+
+    for (LoopPath* path : *loop) {
+      for (SgExpression* constraint : *path->getConstraintList()) {
+        addReads(constraint, access);
+      }
+      addUpdates(path->getVariableTable(), access);
+    }
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      addAll(analyzeLoop(inner), access);
+    }
+    return access;
+  }
+
+  void AccessAnalysis::analyze(Function* func) {
+    AccessAnalysis analysis;
+    Access& whole = func->getAccess();
+    std::map<std::string, Access>& accesses = func->getAccesses();
+
+    for (Function* scope : func->getScopes()) {
+      for (Block* block : scope->getBlocks()) {
+        Access& access = accesses[block->getName()];
+        addUpdates(block->getVariableTable(), access);
+        addAll(access, whole);
+      }
+
+      for (Loop* loop : scope->getLoops()) {
+        const Access& access = analysis.analyzeLoop(loop);
+        accesses[loop->getName()] = access;
+        addAll(access, whole);
+      }
+
+      for (Path* path : scope->getPaths()) {
+        for (SgExpression* constraint : *path->getConstraints()) {
+          addReads(constraint, whole);
+        }
+        addReads(path->getReturnValue(), whole);
+      }
+    }
+
+    // initial values of declared variables are read on entry
+    VariableTable* varTbl = func->getVariableTable();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      addReads(it->second->getInitValue(), whole);
+    }
+  }
+
+}
@@ -0,0 +1,149 @@
+#include "astCache.h"
+#include "fnv.h"
+#include "message.h"
+#include "trace.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace LE {
+
+  // bump it when the layout of cached files changes
+  static const std::string cacheVersion = "le-ast-1";
+
+  // quote an argument for /bin/sh
+  static std::string shellQuote(const std::string& arg) {
+    std::string result = "'";
+    for (char c : arg) {
+      if (c == '\'') {
+        result += "'\\''";
+      } else {
+        result += c;
+      }
+    }
+    return result + "'";
+  }
+
+  // whether a flag affects preprocessing and is forwarded to preprocessor
+  // return number of arguments it takes, 0 if it isn't forwarded
+  static int preprocessorFlag(const std::string& flag) {
+    static const char* joined[] = { "-I", "-D", "-U", "-std=", "-isystem", "-include" };
+    static const char* separate[] = { "-isystem", "-include", "-I", "-D", "-U" };
+
+    for (const char* f : separate) {
+      if (flag == f) return 2;
+    }
+    for (const char* f : joined) {
+      if (flag.compare(0, std::string(f).length(), f) == 0) return 1;
+    }
+    return 0;
+  }
+
+  AstCache::AstCache(const std::string& d): dir(d), hasAst(false) {
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+      Message::error("can't create AST cache directory " + dir);
+    }
+  }
+
+  bool AstCache::computeKey(const std::vector<std::string>& flags,
+                            const std::string& file, std::string& key) {
+    uint64_t hash = fnvOffset;
+    // an AST written by another ROSE or compiler can't be read back
+    hashString(hash, cacheVersion);
+    hashString(hash, version_number());
+    hashString(hash, __VERSION__);
+    for (const std::string& flag : flags) {
+      hashString(hash, flag);
+    }
+    hashString(hash, file);
+
+    const char* cc = std::getenv("CC");
+    std::ostringstream cmd;
+    cmd << shellQuote(cc != nullptr ? cc : "gcc") << " -E";
+    // skip program name
+    for (size_t i = 1; i < flags.size(); ++i) {
+      int n = preprocessorFlag(flags[i]);
+      for (int j = 0; j < n && i + j < flags.size(); ++j) {
+        cmd << ' ' << shellQuote(flags[i + j]);
+      }
+      if (n > 1) i += n - 1;
+    }
+    cmd << ' ' << shellQuote(file) << " 2>/dev/null";
+
+    FILE* pipe = popen(cmd.str().c_str(), "r");
+    if (pipe == nullptr) return false;
+
+    char chunk[65536];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof(chunk), pipe)) > 0) {
+      hashBytes(hash, chunk, len);
+    }
+    if (pclose(pipe) != 0) return false;
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    key = hex;
+    return true;
+  }
+
+  SgProject* AstCache::load(const std::vector<std::string>& flags,
+                            const std::string& file) {
+    std::vector<std::string> args(flags);
+    args.push_back(file);
+
+    // the key is the hash of the preprocessed file
+    long begin = Trace::now();
+    std::string key;
+    bool keyed = computeKey(flags, file, key);
+    Trace::span("cache", "lookup", begin, Trace::now(), "file", file);
+    if (!keyed) {
+      Message::warning("can't preprocess " + file + ", AST is not cached");
+      hasAst = true;
+      TraceScope scope("frontend", file);
+      return frontend(args);
+    }
+
+    // cached AST is loaded into empty memory pools
+    // so that it only contains nodes of this file
+    if (hasAst) {
+      AST_FILE_IO::clearAllMemoryPools();
+    }
+    hasAst = true;
+
+    std::string path = dir + "/" + key + ".ast";
+    if (access(path.c_str(), R_OK) == 0) {
+      TraceScope scope("cache", "read", "file", file);
+      return AST_FILE_IO::readASTFromFile(path);
+    }
+
+    SgProject* project;
+    {
+      TraceScope scope("frontend", file);
+      project = frontend(args);
+    }
+
+    TraceScope scope("cache", "write", "file", file);
+
+    // write to a temporary file first, so that a concurrent run
+    // never reads a partially written AST
+    std::ostringstream tmp;
+    tmp << path << ".tmp" << getpid();
+    AST_FILE_IO::startUp(project);
+    AST_FILE_IO::writeASTToFile(tmp.str());
+    AST_FILE_IO::resetValidAstAfterWriting();
+    if (std::rename(tmp.str().c_str(), path.c_str()) != 0) {
+      std::remove(tmp.str().c_str());
+      Message::warning("can't write AST cache " + path);
+    }
+
+    return project;
+  }
+
+}
@@ -2,6 +2,8 @@
 #include "message.h"
 #include <cassert>
 #include <sstream>
+#include <cctype>
+#include <vector>
 
 namespace LE {
 
@@ -95,6 +97,8 @@ namespace LE {
     typeStrMap[T_BOOL] = "bool";
     typeStrMap[T_ARRAY] = "array";
     typeStrMap[T_POINTER] = "pointer";
+    // type of updates, see Variable
+    typeStrMap[V_SgNode] = "unknown";
   }
 
   //--------------ASTHelper member function-------------------------//
@@ -130,49 +134,221 @@ namespace LE {
     return iter->second;
   }
 
+  bool ASTHelper::isIntegralType(VariantT type) {
+    static const std::set<int> types = {
+      T_CHAR, T_SIGNED_CHAR, T_UNSIGNED_CHAR, T_SHORT, T_SIGNED_SHORT,
+      T_UNSIGNED_SHORT, T_INT, T_SIGNED_INT, T_UNSIGNED_INT, T_LONG,
+      T_SIGNED_LONG, T_UNSIGNED_LONG, T_LONG_LONG, T_SIGNED_LONG_LONG,
+      T_UNSIGNED_LONG_LONG, T_BOOL
+    };
+    return types.count(type) > 0;
+  }
+
+  bool ASTHelper::isIntegralType(SgType* type) {
+    if (type == nullptr) return false;
+    return isIntegralType(type->stripTypedefsAndModifiers()->variantT());
+  }
+
+  std::string ASTHelper::getLocation(SgNode* node) {
+    Sg_File_Info* info = node == nullptr ? nullptr : node->get_file_info();
+    if (info == nullptr || info->get_line() <= 0) return "";
+
+    std::ostringstream oss;
+    oss << info->get_filenameString() << ":" << info->get_line();
+    return oss.str();
+  }
+
   void ASTHelper::replaceVar(SgNode* tree,
     SgExpression *newValue, const std::string& name) {
-    // if it is a binary operator
-    // replace both side (lhs and rhs) with the new value
-    // if it is the variable we want
-    if (SgBinaryOp *binOp = dynamic_cast<SgBinaryOp*>(tree)) {
-      SgExpression* left = binOp->get_lhs_operand();
-      // if lhs operand is a variable
-      // check whether it is the variable we looking for by its name
-      // if it is, replace its value with new value
-      // otherwise, ignore it
-      if (SgVarRefExp *leftVar = dynamic_cast<SgVarRefExp*>(left)) {
-        std::string n = leftVar->get_symbol()->get_name().getString();
-        if (name == n) {
+    // subtrees left to traverse, an explicit stack instead of recursion
+    // as generated code may nest expressions thousands of levels deep
+    std::vector<SgNode*> stack(1, tree);
+
+    // whether an operand is the variable we are looking for
+    // an operand that is not a variable is traversed later
+    auto isTarget = [&](SgExpression* operand) {
+      if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(operand)) {
+        return var->get_symbol()->get_name().getString() == name;
+      }
+      if (operand != nullptr) {
+        stack.push_back(operand);
+      }
+      return false;
+    };
+
+    while (!stack.empty()) {
+      SgNode* node = stack.back();
+      stack.pop_back();
+
+      if (SgBinaryOp *binOp = dynamic_cast<SgBinaryOp*>(node)) {
+        // replace both side (lhs and rhs) with the new value
+        // if it is the variable we want
+        if (isTarget(binOp->get_rhs_operand())) {
+          binOp->set_rhs_operand(newValue);
+        }
+        if (isTarget(binOp->get_lhs_operand())) {
           binOp->set_lhs_operand(newValue);
         }
+      } else if (SgUnaryOp *uOp = dynamic_cast<SgUnaryOp*>(node)) {
+        if (isTarget(uOp->get_operand())) {
+          uOp->set_operand(newValue);
+        }
+      } else if (SgConditionalExp* condExp = dynamic_cast<SgConditionalExp*>(node)) {
+        // conditional and arguments of calls, e.g. from CallSummaries
+        if (isTarget(condExp->get_false_exp())) {
+          condExp->set_false_exp(newValue);
+        }
+        if (isTarget(condExp->get_true_exp())) {
+          condExp->set_true_exp(newValue);
+        }
+        if (isTarget(condExp->get_conditional_exp())) {
+          condExp->set_conditional_exp(newValue);
+        }
+      } else if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(node)) {
+        std::vector<SgExpression*>& args = call->get_args()->get_expressions();
+        for (auto it = args.rbegin(), ie = args.rend(); it != ie; ++it) {
+          if (isTarget(*it)) {
+            *it = newValue;
+          }
+        }
+      }
+    }
+  }
+
+  // return value of a variable if it is in values, otherwise nullptr
+  static SgExpression* findValue(SgExpression* expr,
+    const std::map<std::string, SgExpression*>& values) {
+    SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr);
+    if (var == nullptr) return nullptr;
+
+    auto iter = values.find(var->get_symbol()->get_name().getString());
+    return iter == values.end() ? nullptr : iter->second;
+  }
+
+  // replace the i-th operand of an expression, see ASTHelper::getOperands
+  static void setOperand(SgExpression* expr, size_t i, SgExpression* operand) {
+    if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+      if (i == 0) {
+        binOp->set_lhs_operand(operand);
       } else {
-        // if it is not a variable, recursively to traverse subtree
-        replaceVar(left, newValue, name);
+        binOp->set_rhs_operand(operand);
       }
+    } else if (SgUnaryOp* uOp = dynamic_cast<SgUnaryOp*>(expr)) {
+      uOp->set_operand(operand);
+    } else if (SgAssignInitializer* initializer = dynamic_cast<SgAssignInitializer*>(expr)) {
+      initializer->set_operand(operand);
+    } else if (SgConditionalExp* condExp = dynamic_cast<SgConditionalExp*>(expr)) {
+      if (i == 0) {
+        condExp->set_conditional_exp(operand);
+      } else if (i == 1) {
+        condExp->set_true_exp(operand);
+      } else {
+        condExp->set_false_exp(operand);
+      }
+    } else if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(expr)) {
+      call->get_args()->get_expressions()[i] = operand;
+    }
+  }
 
-      // do similar thing as lhs operand
-      SgExpression* right = binOp->get_rhs_operand();
-      if (SgVarRefExp *rightVar = dynamic_cast<SgVarRefExp*>(right)) {
-        std::string n = rightVar->get_symbol()->get_name().getString();
-        if (name == n) {
-          binOp->set_rhs_operand(newValue);
+  SgExpression* ASTHelper::substitute(SgExpression* expr,
+    const std::map<std::string, SgExpression*>& values) {
+    if (expr == nullptr) return nullptr;
+
+    if (SgExpression* value = findValue(expr, values)) {
+      return clone(value);
+    }
+
+    // inserted values are not traversed, so they are never replaced again
+    SgExpression* result = clone(expr);
+    std::set<SgExpression*> inserted;
+    traverse(result, [&](SgExpression* node) {
+      if (inserted.count(node) > 0) return false;
+
+      std::vector<SgExpression*>&& operands = getOperands(node);
+      for (size_t i = 0; i < operands.size(); ++i) {
+        if (SgExpression* value = findValue(operands[i], values)) {
+          SgExpression* copy = clone(value);
+          setOperand(node, i, copy);
+          inserted.insert(copy);
         }
-      } else {
-        replaceVar(right, newValue, name);
       }
-    } else if (SgUnaryOp *uOp = dynamic_cast<SgUnaryOp*>(tree)) {
-      // if it is a unary operator
-      // do similar thing as binary operator does
-      SgExpression* operand = uOp->get_operand();
-      if (SgVarRefExp *var = dynamic_cast<SgVarRefExp*>(operand)) {
-        std::string n = var->get_symbol()->get_name().getString();
-        if (name == n) {
-          uOp->set_operand(newValue);
+      return true;
+    });
+    return result;
+  }
+
+  void ASTHelper::collectVarNames(SgNode* tree, std::set<std::string>& names) {
+    traverse(dynamic_cast<SgExpression*>(tree), [&](SgExpression* expr) {
+      if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr)) {
+        names.insert(var->get_symbol()->get_name().getString());
+      }
+      return true;
+    });
+  }
+
+  std::vector<SgExpression*> ASTHelper::getOperands(SgExpression* expr) {
+    std::vector<SgExpression*> operands;
+    if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+      operands.push_back(binOp->get_lhs_operand());
+      operands.push_back(binOp->get_rhs_operand());
+    } else if (SgUnaryOp* uOp = dynamic_cast<SgUnaryOp*>(expr)) {
+      operands.push_back(uOp->get_operand());
+    } else if (SgAssignInitializer* initializer = dynamic_cast<SgAssignInitializer*>(expr)) {
+      operands.push_back(initializer->get_operand());
+    } else if (SgConditionalExp* condExp = dynamic_cast<SgConditionalExp*>(expr)) {
+      operands.push_back(condExp->get_conditional_exp());
+      operands.push_back(condExp->get_true_exp());
+      operands.push_back(condExp->get_false_exp());
+    } else if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(expr)) {
+      operands = call->get_args()->get_expressions();
+    }
+    return operands;
+  }
+
+  void ASTHelper::traverse(SgExpression* tree,
+    const std::function<bool(SgExpression*)>& enter,
+    const std::function<void(SgExpression*)>& leave) {
+    // an expression is on the stack twice: to enter, then to leave
+    std::vector<std::pair<SgExpression*, bool> > stack(1, std::make_pair(tree, false));
+    while (!stack.empty()) {
+      SgExpression* expr = stack.back().first;
+      bool left = stack.back().second;
+      stack.pop_back();
+
+      if (left) {
+        leave(expr);
+        continue;
+      }
+
+      bool operands = enter(expr);
+      if (leave) {
+        stack.push_back(std::make_pair(expr, true));
+      }
+      if (operands && expr != nullptr) {
+        std::vector<SgExpression*>&& children = getOperands(expr);
+        for (auto it = children.rbegin(), ie = children.rend(); it != ie; ++it) {
+          stack.push_back(std::make_pair(*it, false));
         }
-      } else {
-        replaceVar(operand, newValue, name);
       }
     }
   }
+
+  std::string ASTHelper::getBaseName(const std::string& operand) {
+    // skip leading '(' and '*' of a dereference
+    std::string::size_type begin = 0;
+    while (begin < operand.length() && !isalpha(operand[begin]) && operand[begin] != '_') {
+      ++begin;
+    }
+
+    std::string::size_type end = begin;
+    while (end < operand.length() && (isalnum(operand[end]) || operand[end] == '_')) {
+      ++end;
+    }
+
+    return operand.substr(begin, end - begin);
+  }
+
+  bool ASTHelper::isPlainName(const std::string& operand) {
+    return !operand.empty() && getBaseName(operand) == operand;
+  }
 }
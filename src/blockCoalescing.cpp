@@ -0,0 +1,139 @@
+#include "blockCoalescing.h"
+#include "astHelper.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace LE {
+
+  bool BlockCoalescing::isComposable(Block* block) {
+    VariableTable* varTbl = block->getVariableTable();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      if (!ASTHelper::isPlainName(it->first)) return false;
+    }
+    return true;
+  }
+
+  void BlockCoalescing::compose(Block* first, Block* second) {
+    VariableTable* firstTbl = first->getVariableTable();
+    VariableTable* secondTbl = second->getVariableTable();
+
+    // values of second block refer to variables at its beginning
+    // i.e. to values updated by first block
+    std::map<std::string, SgExpression*> values;
+    for (auto it = firstTbl->begin(), ie = firstTbl->end(); it != ie; ++it) {
+      values[it->first] = it->second->getValue();
+    }
+
+    std::vector<Variable*> updates;
+    for (auto it = secondTbl->begin(), ie = secondTbl->end(); it != ie; ++it) {
+      SgExpression* value = ASTHelper::substitute(it->second->getValue(), values);
+      updates.push_back(new Variable(it->first, value));
+    }
+
+    for (Variable* var : updates) {
+      firstTbl->addVariable(var);
+    }
+  }
+
+  bool BlockCoalescing::isCheckedBefore(Path* path, const std::string& name) {
+    const std::vector<std::string>& elements = path->getPaths();
+    auto it = std::find(elements.begin(), elements.end(), name);
+    if (it == elements.end()) return false;
+
+    size_t step = it - elements.begin();
+    ConstraintList* cl = path->getConstraints();
+    for (size_t i = 0; i < cl->size(); ++i) {
+      if (cl->getStep(i) == step) return true;
+    }
+    return false;
+  }
+
+  int BlockCoalescing::coalesce(Function* func) {
+    std::map<std::string, Block*> blocks;
+    for (Block* block : func->getBlocks()) {
+      blocks[block->getName()] = block;
+    }
+
+    int fused = 0;
+    bool changed = true;
+    while (changed) {
+      changed = false;
+
+      // successor and predecessor of every block in all paths
+      // an empty string means 'none', and '*' means 'differs between paths'
+      std::map<std::string, std::string> next, prev;
+      for (Path* path : func->getPaths()) {
+        const std::vector<std::string>& elements = path->getPaths();
+        for (size_t i = 0; i < elements.size(); ++i) {
+          std::string succ = i + 1 < elements.size() ? elements[i + 1] : "";
+          std::string pred = i > 0 ? elements[i - 1] : "";
+
+          auto n = next.find(elements[i]);
+          if (n == next.end()) {
+            next[elements[i]] = succ;
+          } else if (n->second != succ) {
+            n->second = "*";
+          }
+
+          auto p = prev.find(elements[i]);
+          if (p == prev.end()) {
+            prev[elements[i]] = pred;
+          } else if (p->second != pred) {
+            p->second = "*";
+          }
+        }
+      }
+
+      for (auto& entry : next) {
+        const std::string& a = entry.first;
+        const std::string& b = entry.second;
+        if (!blocks.count(a) || !blocks.count(b) || prev[b] != a) continue;
+
+        Block* first = blocks[a];
+        Block* second = blocks[b];
+        if (!isComposable(first) || !isComposable(second)) continue;
+
+        bool checked = false;
+        for (Path* path : func->getPaths()) {
+          checked = checked || isCheckedBefore(path, b);
+        }
+        if (checked) continue;
+
+        compose(first, second);
+
+        // constraints after b move one step back
+        for (Path* path : func->getPaths()) {
+          std::vector<std::string> elements;
+          size_t removed = 0;
+          for (const std::string& element : path->getPaths()) {
+            if (element != b) {
+              elements.push_back(element);
+            } else {
+              removed = elements.size() + 1;
+            }
+          }
+          path->setPaths(elements);
+
+          ConstraintList* cl = path->getConstraints();
+          for (size_t i = 0; removed > 0 && i < cl->size(); ++i) {
+            if (cl->getStep(i) >= removed) {
+              cl->setStep(i, cl->getStep(i) - 1);
+            }
+          }
+        }
+        func->removeBlock(second);
+        blocks.erase(b);
+        delete second;
+
+        ++fused;
+        changed = true;
+        break;
+      }
+    }
+
+    return fused;
+  }
+
+}
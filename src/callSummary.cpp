@@ -0,0 +1,441 @@
+#include "callSummary.h"
+#include "astHelper.h"
+#include <algorithm>
+
+namespace LE {
+
+  // name of a variable if expr is a plain variable, otherwise empty
+  static std::string getVarName(SgExpression* expr) {
+    SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr);
+    return var == nullptr ? "" : var->get_symbol()->get_name().getString();
+  }
+
+  SgExpression* CallSummaries::current(State& state, const std::string& name) {
+    auto it = state.values.find(name);
+    if (it != state.values.end()) return it->second;
+    return entryRefs[name];
+  }
+
+  void CallSummaries::assign(State& state, const std::string& name, SgExpression* value) {
+    // paths that have returned keep the old value
+    if (state.returned != nullptr) {
+      value = new SgConditionalExp(ASTHelper::clone(state.returned),
+                                   ASTHelper::clone(current(state, name)),
+                                   value, value->get_type());
+    }
+    state.values[name] = value;
+  }
+
+  void CallSummaries::merge(State& state, SgExpression* cond, State& t, State& f) {
+    std::set<std::string> names;
+    for (auto& v : t.values) names.insert(v.first);
+    for (auto& v : f.values) names.insert(v.first);
+
+    for (const std::string& name : names) {
+      SgExpression* a = current(t, name);
+      SgExpression* b = current(f, name);
+      if (a == b) continue;
+      state.values[name] = new SgConditionalExp(ASTHelper::clone(cond),
+                                                ASTHelper::clone(a),
+                                                ASTHelper::clone(b), a->get_type());
+    }
+
+    state.done = t.done && f.done;
+    if (!t.done && !f.done && t.returned == f.returned) {
+      // neither branch returns
+      state.returned = t.returned;
+    } else {
+      // condition under which a branch has returned
+      SgType* boolType = SgTypeBool::createType();
+      auto returnedIn = [&](SgExpression* c, State& s) -> SgExpression* {
+        if (s.done) return c;
+        if (s.returned == nullptr) return nullptr;
+        return new SgAndOp(c, ASTHelper::clone(s.returned), boolType);
+      };
+      SgExpression* rt = returnedIn(ASTHelper::clone(cond), t);
+      SgExpression* rf = returnedIn(new SgNotOp(ASTHelper::clone(cond), boolType), f);
+      if (rt != nullptr && rf != nullptr) {
+        state.returned = new SgOrOp(rt, rf, boolType);
+      } else {
+        state.returned = rt != nullptr ? rt : rf;
+      }
+    }
+
+    if (t.result != nullptr && f.result != nullptr && t.result != f.result) {
+      state.result = new SgConditionalExp(ASTHelper::clone(cond),
+                                          ASTHelper::clone(t.result),
+                                          ASTHelper::clone(f.result), t.result->get_type());
+    } else {
+      state.result = t.result != nullptr ? t.result : f.result;
+    }
+  }
+
+  SgExpression* CallSummaries::evaluate(SgExpression* expr, State& state) {
+    if (expr == nullptr) return nullptr;
+
+    if (dynamic_cast<SgValueExp*>(expr)) {
+      return ASTHelper::clone(expr);
+    }
+
+    if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr)) {
+      auto it = state.values.find(var->get_symbol()->get_name().getString());
+      return ASTHelper::clone(it == state.values.end() ? expr : it->second);
+    }
+
+    if (SgAssignInitializer* initializer = dynamic_cast<SgAssignInitializer*>(expr)) {
+      return evaluate(initializer->get_operand(), state);
+    }
+
+    if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(expr)) {
+      std::vector<SgExpression*> args;
+      for (SgExpression* arg : call->get_args()->get_expressions()) {
+        SgExpression* value = evaluate(arg, state);
+        if (value == nullptr) return nullptr;
+        args.push_back(value);
+      }
+
+      // a function defined elsewhere is kept as an uninterpreted call
+      // e.g. sqrt(x), it is assumed not to update our variables
+      if (!isDefined(call)) {
+        SgFunctionCallExp* copy = ASTHelper::clone(call);
+        copy->get_args()->get_expressions() = args;
+        return copy;
+      }
+
+      CallSummary* summary = getSummary(call);
+      if (summary == nullptr) return nullptr;
+
+      // callee sees current values of non-local variables
+      std::map<std::string, SgExpression*>&& values = bind(summary, args);
+      for (auto& v : state.values) {
+        if (locals.count(v.first) == 0) values.insert(v);
+      }
+
+      SgExpression* retVal = summary->retVal == nullptr ?
+        ASTHelper::clone(call) : ASTHelper::substitute(summary->retVal, values);
+
+      std::map<std::string, SgExpression*> updates;
+      for (auto& u : summary->updates) {
+        // a non-local of callee shadowed by a local of caller
+        if (locals.count(u.first) > 0) return nullptr;
+        updates[u.first] = ASTHelper::substitute(u.second, values);
+      }
+      for (auto& u : updates) {
+        entryRefs.insert(std::make_pair(u.first, ASTHelper::clone(summary->targets[u.first])));
+        assign(state, u.first, u.second);
+      }
+      return retVal;
+    }
+
+    if (SgConditionalExp* condExp = dynamic_cast<SgConditionalExp*>(expr)) {
+      SgExpression* cond = evaluate(condExp->get_conditional_exp(), state);
+
+      // branches must not write variables
+      State t = state, f = state;
+      SgExpression* a = evaluate(condExp->get_true_exp(), t);
+      SgExpression* b = evaluate(condExp->get_false_exp(), f);
+      if (cond == nullptr || a == nullptr || b == nullptr ||
+          t.values != state.values || f.values != state.values) {
+        return nullptr;
+      }
+      return new SgConditionalExp(cond, a, b, condExp->get_type());
+    }
+
+    if (SgAssignOp* assignOp = dynamic_cast<SgAssignOp*>(expr)) {
+      std::string&& name = getVarName(assignOp->get_lhs_operand());
+      if (name.empty()) return nullptr;
+
+      SgExpression* value = evaluate(assignOp->get_rhs_operand(), state);
+      if (value == nullptr) return nullptr;
+
+      entryRefs.insert(std::make_pair(name, ASTHelper::clone(assignOp->get_lhs_operand())));
+      assign(state, name, value);
+      return ASTHelper::clone(value);
+    }
+
+    if (SgCompoundAssignOp* compoundOp = dynamic_cast<SgCompoundAssignOp*>(expr)) {
+      std::string&& name = getVarName(compoundOp->get_lhs_operand());
+      if (name.empty()) return nullptr;
+
+      SgExpression* rhs = evaluate(compoundOp->get_rhs_operand(), state);
+      if (rhs == nullptr) return nullptr;
+
+      entryRefs.insert(std::make_pair(name, ASTHelper::clone(compoundOp->get_lhs_operand())));
+      SgExpression* value = ASTHelper::toBinaryOp(compoundOp->variantT(),
+        ASTHelper::clone(current(state, name)), rhs, compoundOp->get_type());
+      assign(state, name, value);
+      return ASTHelper::clone(value);
+    }
+
+    SgUnaryOp* unaryOp;
+    if ((unaryOp = dynamic_cast<SgPlusPlusOp*>(expr)) ||
+        (unaryOp = dynamic_cast<SgMinusMinusOp*>(expr))) {
+      std::string&& name = getVarName(unaryOp->get_operand());
+      if (name.empty()) return nullptr;
+
+      entryRefs.insert(std::make_pair(name, ASTHelper::clone(unaryOp->get_operand())));
+      SgExpression* old = current(state, name);
+      SgUnaryOp* value = ASTHelper::clone(unaryOp);
+      value->set_operand(ASTHelper::clone(old));
+      assign(state, name, value);
+      return unaryOp->get_mode() == SgUnaryOp::prefix ?
+        ASTHelper::clone(static_cast<SgExpression*>(value)) : ASTHelper::clone(old);
+    }
+
+    if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+      SgExpression* lhs = evaluate(binOp->get_lhs_operand(), state);
+
+      // rhs of && and || may not run, so it must not write variables
+      State copy = state;
+      bool shortCircuit = dynamic_cast<SgAndOp*>(binOp) || dynamic_cast<SgOrOp*>(binOp);
+      SgExpression* rhs = evaluate(binOp->get_rhs_operand(), shortCircuit ? copy : state);
+      if (lhs == nullptr || rhs == nullptr || (shortCircuit && copy.values != state.values)) {
+        return nullptr;
+      }
+
+      SgBinaryOp* result = ASTHelper::clone(binOp);
+      result->set_lhs_operand(lhs);
+      result->set_rhs_operand(rhs);
+      return result;
+    }
+
+    if ((unaryOp = dynamic_cast<SgUnaryOp*>(expr))) {
+      SgExpression* operand = evaluate(unaryOp->get_operand(), state);
+      if (operand == nullptr) return nullptr;
+
+      SgUnaryOp* result = ASTHelper::clone(unaryOp);
+      result->set_operand(operand);
+      return result;
+    }
+
+    return nullptr;
+  }
+
+  bool CallSummaries::execute(SgStatement* stmt, State& state) {
+    // statements after return never run
+    if (state.done || stmt == nullptr) return true;
+
+    if (SgBasicBlock* block = dynamic_cast<SgBasicBlock*>(stmt)) {
+      for (SgStatement* s : block->get_statements()) {
+        if (!execute(s, state)) return false;
+      }
+      return true;
+    }
+
+    if (SgExprStatement* exprStmt = dynamic_cast<SgExprStatement*>(stmt)) {
+      return evaluate(exprStmt->get_expression(), state) != nullptr;
+    }
+
+    if (SgVariableDeclaration* varDecl = dynamic_cast<SgVariableDeclaration*>(stmt)) {
+      for (SgInitializedName* name : varDecl->get_variables()) {
+        std::string n = name->get_name().getString();
+        locals.insert(n);
+        entryRefs[n] = new SgVarRefExp(new SgVariableSymbol(name));
+        state.values.erase(n);
+
+        SgAssignInitializer* initializer = dynamic_cast<SgAssignInitializer*>(name->get_initptr());
+        if (initializer != nullptr) {
+          SgExpression* value = evaluate(initializer->get_operand(), state);
+          if (value == nullptr) return false;
+          assign(state, n, value);
+        }
+      }
+      return true;
+    }
+
+    if (SgReturnStmt* returnStmt = dynamic_cast<SgReturnStmt*>(stmt)) {
+      SgExpression* expr = returnStmt->get_expression();
+      SgExpression* value = evaluate(expr, state);
+      if (expr != nullptr && value == nullptr) return false;
+
+      if (state.returned == nullptr || state.result == nullptr) {
+        state.result = value;
+      } else if (value != nullptr) {
+        state.result = new SgConditionalExp(ASTHelper::clone(state.returned),
+                                            state.result, value, value->get_type());
+      }
+      state.done = true;
+      return true;
+    }
+
+    if (SgIfStmt* ifStmt = dynamic_cast<SgIfStmt*>(stmt)) {
+      SgExprStatement* condStmt = dynamic_cast<SgExprStatement*>(ifStmt->get_conditional());
+      if (condStmt == nullptr) return false;
+
+      SgExpression* cond = evaluate(condStmt->get_expression(), state);
+      if (cond == nullptr) return false;
+
+      State t = state, f = state;
+      if (!execute(ifStmt->get_true_body(), t) || !execute(ifStmt->get_false_body(), f)) {
+        return false;
+      }
+      merge(state, cond, t, f);
+      return true;
+    }
+
+    // loops, switch, goto ...
+    return false;
+  }
+
+  CallSummary* CallSummaries::summarize(SgFunctionDeclaration* funcDecl) {
+    SgFunctionDefinition* funcDef = funcDecl == nullptr ? nullptr : funcDecl->get_definition();
+    if (funcDef == nullptr) return nullptr;
+
+    // a callee is summarized in the middle of its caller
+    std::set<std::string> outerLocals;
+    std::map<std::string, SgExpression*> outerRefs;
+    outerLocals.swap(locals);
+    outerRefs.swap(entryRefs);
+
+    CallSummary* summary = new CallSummary;
+    for (SgInitializedName* param : funcDecl->get_parameterList()->get_args()) {
+      std::string name = param->get_name().getString();
+      summary->params.push_back(name);
+      locals.insert(name);
+      entryRefs[name] = new SgVarRefExp(new SgVariableSymbol(param));
+    }
+
+    State state;
+    bool ok = execute(funcDef->get_body(), state);
+    if (ok) {
+      summary->retVal = state.result;
+      for (auto& v : state.values) {
+        if (locals.count(v.first) == 0) {
+          summary->updates[v.first] = v.second;
+          summary->targets[v.first] = entryRefs[v.first];
+        }
+      }
+
+      // values are in terms of parameters and non-locals at entry
+      std::set<std::string> names;
+      if (summary->retVal != nullptr) {
+        ASTHelper::collectVarNames(summary->retVal, names);
+      }
+      for (auto& u : summary->updates) {
+        names.insert(u.first);
+        ASTHelper::collectVarNames(u.second, names);
+      }
+      for (const std::string& name : names) {
+        if (std::find(summary->params.begin(), summary->params.end(), name) == summary->params.end()) {
+          summary->nonLocals.insert(name);
+        }
+      }
+    } else {
+      delete summary;
+      summary = nullptr;
+    }
+
+    locals.swap(outerLocals);
+    entryRefs.swap(outerRefs);
+    return summary;
+  }
+
+  std::map<std::string, SgExpression*> CallSummaries::bind(
+    CallSummary* summary, const std::vector<SgExpression*>& args) {
+    std::map<std::string, SgExpression*> values;
+    for (size_t i = 0; i < summary->params.size() && i < args.size(); ++i) {
+      values[summary->params[i]] = args[i];
+    }
+    return values;
+  }
+
+  bool CallSummaries::isDefined(SgFunctionCallExp* call) {
+    SgFunctionDeclaration* decl = call->getAssociatedFunctionDeclaration();
+    return decl != nullptr && decl->get_definingDeclaration() != nullptr;
+  }
+
+  bool CallSummaries::isShadowed(CallSummary* summary) const {
+    for (const std::string& name : summary->nonLocals) {
+      if (callerLocals.count(name) > 0) return true;
+    }
+    return false;
+  }
+
+  bool CallSummaries::isOpaque(SgFunctionCallExp* call) {
+    CallSummary* summary = getSummary(call);
+    return summary == nullptr || isShadowed(summary);
+  }
+
+  CallSummary* CallSummaries::getSummary(SgFunctionCallExp* call) {
+    if (!isDefined(call)) return nullptr;
+    SgDeclarationStatement* def =
+      call->getAssociatedFunctionDeclaration()->get_definingDeclaration();
+
+    auto it = summaries.find(def);
+    if (it != summaries.end()) return it->second;
+
+    // a recursive call, every function on the cycle
+    // fails to be summarized and is memoized as such
+    if (inProgress.count(def) > 0) return nullptr;
+
+    inProgress.insert(def);
+    CallSummary* summary = summarize(dynamic_cast<SgFunctionDeclaration*>(def));
+    inProgress.erase(def);
+
+    summaries[def] = summary;
+    return summary;
+  }
+
+  SgExpression* CallSummaries::replaceCalls(SgExpression* expr) {
+    if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(expr)) {
+      std::vector<SgExpression*>& args = call->get_args()->get_expressions();
+      for (SgExpression*& arg : args) {
+        arg = replaceCalls(arg);
+      }
+
+      CallSummary* summary = getSummary(call);
+      if (summary == nullptr || summary->retVal == nullptr || isShadowed(summary)) return call;
+      return ASTHelper::substitute(summary->retVal, bind(summary, args));
+    } else if (SgConditionalExp* condExp = dynamic_cast<SgConditionalExp*>(expr)) {
+      condExp->set_conditional_exp(replaceCalls(condExp->get_conditional_exp()));
+      condExp->set_true_exp(replaceCalls(condExp->get_true_exp()));
+      condExp->set_false_exp(replaceCalls(condExp->get_false_exp()));
+    } else if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+      binOp->set_lhs_operand(replaceCalls(binOp->get_lhs_operand()));
+      binOp->set_rhs_operand(replaceCalls(binOp->get_rhs_operand()));
+    } else if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(expr)) {
+      unaryOp->set_operand(replaceCalls(unaryOp->get_operand()));
+    }
+    return expr;
+  }
+
+  bool CallSummaries::hasOrderedCalls(SgExpression* expr) {
+    int calls = 0;
+    bool updates = false;
+    ASTHelper::traverse(expr, [&](SgExpression* node) {
+      if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(node)) {
+        CallSummary* summary = getSummary(call);
+        if (summary != nullptr && !isShadowed(summary)) {
+          ++calls;
+          updates = updates || !summary->updates.empty();
+        }
+      }
+      return true;
+    });
+    return calls > 1 && updates;
+  }
+
+  SgExpression* CallSummaries::inlineCalls(SgExpression* expr) {
+    SgExpression* result = ASTHelper::clone(expr);
+    if (hasOrderedCalls(result)) return result;
+    return replaceCalls(result);
+  }
+
+  std::map<std::string, SgExpression*> CallSummaries::getUpdates(SgFunctionCallExp* call) {
+    std::map<std::string, SgExpression*> updates;
+    CallSummary* summary = getSummary(call);
+    if (summary == nullptr || isShadowed(summary)) return updates;
+
+    std::vector<SgExpression*> args;
+    for (SgExpression* arg : call->get_args()->get_expressions()) {
+      args.push_back(inlineCalls(arg));
+    }
+
+    std::map<std::string, SgExpression*>&& values = bind(summary, args);
+    for (auto& u : summary->updates) {
+      updates[u.first] = ASTHelper::substitute(u.second, values);
+    }
+    return updates;
+  }
+
+}
@@ -0,0 +1,520 @@
+#include "dependence.h"
+#include "astHelper.h"
+#include "printer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace LE {
+
+  namespace {
+
+    long gcd(long a, long b) {
+      a = std::labs(a);
+      b = std::labs(b);
+      while (b != 0) {
+        long t = a % b;
+        a = b;
+        b = t;
+      }
+      return a;
+    }
+
+    std::string toString(SgExpression* expr) {
+      std::ostringstream oss;
+      JsonPrinter printer;
+      printer.printExpression(oss, expr);
+      return oss.str();
+    }
+
+    std::string getKind(bool srcWrite, bool sinkWrite) {
+      if (srcWrite && sinkWrite) return "output";
+      return srcWrite ? "flow" : "anti";
+    }
+
+  }
+
+  bool DependenceAnalysis::getConstant(SgExpression* expr, long& value) {
+    SgValueExp* valueExp = dynamic_cast<SgValueExp*>(expr);
+    if (valueExp == nullptr || dynamic_cast<SgBoolValExp*>(expr)) return false;
+
+    std::string&& str = valueExp->get_constant_folded_value_as_string();
+    char* end = nullptr;
+    value = std::strtol(str.c_str(), &end, 10);
+    return !str.empty() && *end == '\0';
+  }
+
+  bool DependenceAnalysis::getStep(SgExpression* value, const std::string& name,
+                                   long& step) {
+    SgUnaryOp* unaryOp;
+    if ((unaryOp = dynamic_cast<SgPlusPlusOp*>(value)) ||
+        (unaryOp = dynamic_cast<SgMinusMinusOp*>(value))) {
+      SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(unaryOp->get_operand());
+      if (var == nullptr || var->get_symbol()->get_name().getString() != name) {
+        return false;
+      }
+      step = dynamic_cast<SgPlusPlusOp*>(value) ? 1 : -1;
+      return true;
+    }
+
+    SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(value);
+    if (!dynamic_cast<SgAddOp*>(value) && !dynamic_cast<SgSubtractOp*>(value)) {
+      return false;
+    }
+
+    // 'i + c', 'c + i' or 'i - c'
+    SgExpression* lhs = binOp->get_lhs_operand();
+    SgExpression* rhs = binOp->get_rhs_operand();
+    if (dynamic_cast<SgAddOp*>(value) && dynamic_cast<SgValueExp*>(lhs)) {
+      std::swap(lhs, rhs);
+    }
+
+    SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(lhs);
+    if (var == nullptr || var->get_symbol()->get_name().getString() != name ||
+        !getConstant(rhs, step)) {
+      return false;
+    }
+    if (dynamic_cast<SgSubtractOp*>(value)) step = -step;
+    return true;
+  }
+
+  void DependenceAnalysis::collectWritten(Loop* loop, std::set<std::string>& names,
+                                          std::set<Loop*>& visited) {
+    if (!visited.insert(loop).second) return;
+
+    for (LoopPath* path : *loop) {
+      VariableTable* varTbl = path->getVariableTable();
+      for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+        names.insert(it->first);
+      }
+    }
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      collectWritten(inner, names, visited);
+    }
+  }
+
+  void DependenceAnalysis::findInductions(Loop* loop) {
+    // an induction variable has the same step on every path
+    // that goes on to the next iteration
+    std::map<std::string, long> steps;
+    bool first = true;
+    for (LoopPath* path : *loop) {
+      if (path->canBreakLoop()) continue;
+
+      std::map<std::string, long> pathSteps;
+      VariableTable* varTbl = path->getVariableTable();
+      for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+        long step;
+        if (ASTHelper::isPlainName(it->first) &&
+            getStep(it->second->getValue(), it->first, step) && step != 0) {
+          pathSteps[it->first] = step;
+        }
+      }
+
+      if (first) {
+        steps = pathSteps;
+        first = false;
+      } else {
+        for (auto it = steps.begin(); it != steps.end();) {
+          auto iter = pathSteps.find(it->first);
+          if (iter == pathSteps.end() || iter->second != it->second) {
+            it = steps.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+    }
+
+    std::set<std::string> written;
+    std::set<Loop*> visited;
+    visited.insert(loop);
+    for (Loop* inner : loop->getInnerLoops()) {
+      collectWritten(inner, written, visited);
+    }
+    for (const std::string& name : written) {
+      steps.erase(name);
+    }
+
+    inductions[loop] = steps;
+  }
+
+  bool DependenceAnalysis::isInduction(const std::string& name) const {
+    for (auto& loopSteps : inductions) {
+      if (loopSteps.second.count(name) > 0) return true;
+    }
+    return false;
+  }
+
+  int DependenceAnalysis::getLevel(const std::string& name, const std::vector<Loop*>& nest,
+                                   size_t depth) const {
+    for (size_t i = 0; i < depth && i < nest.size(); ++i) {
+      auto iter = inductions.find(nest[i]);
+      if (iter != inductions.end() && iter->second.count(name) > 0) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  bool DependenceAnalysis::toAffine(SgExpression* expr, Affine& result) const {
+    // only sums, negations and multiples are searched for affine operands
+    auto isLinear = [](SgExpression* node) {
+      return dynamic_cast<SgCastExp*>(node) || dynamic_cast<SgUnaryAddOp*>(node) ||
+             dynamic_cast<SgMinusOp*>(node) || dynamic_cast<SgPlusPlusOp*>(node) ||
+             dynamic_cast<SgMinusMinusOp*>(node) || dynamic_cast<SgAddOp*>(node) ||
+             dynamic_cast<SgSubtractOp*>(node) || dynamic_cast<SgMultiplyOp*>(node);
+    };
+
+    // forms of the operands left, whether each is affine
+    std::vector<std::pair<bool, Affine> > forms;
+    ASTHelper::traverse(expr, [&](SgExpression* node) {
+      long value;
+      return !getConstant(node, value) && isLinear(node);
+    }, [&](SgExpression* node) {
+      std::pair<bool, Affine> form(true, Affine());
+      Affine& affine = form.second;
+      long value;
+      if (getConstant(node, value)) {
+        affine.constant = value;
+      } else if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(node)) {
+        std::string name = var->get_symbol()->get_name().getString();
+        form.first = modified.count(name) == 0 || isInduction(name);
+        affine.coeffs[name] = 1;
+      } else if (!isLinear(node)) {
+        form.first = false;
+      } else if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(node)) {
+        form = forms.back();
+        forms.pop_back();
+
+        if (dynamic_cast<SgMinusOp*>(unaryOp)) {
+          for (auto& coeff : affine.coeffs) coeff.second = -coeff.second;
+          affine.constant = -affine.constant;
+        } else if (dynamic_cast<SgPlusPlusOp*>(unaryOp)) {
+          // value of an updated '++i' is 'i + 1'
+          affine.constant += 1;
+        } else if (dynamic_cast<SgMinusMinusOp*>(unaryOp)) {
+          affine.constant -= 1;
+        }
+      } else {
+        std::pair<bool, Affine> rhs = forms.back();
+        forms.pop_back();
+        std::pair<bool, Affine> lhs = forms.back();
+        forms.pop_back();
+        form.first = lhs.first && rhs.first;
+
+        if (!dynamic_cast<SgMultiplyOp*>(node)) {
+          long sign = dynamic_cast<SgAddOp*>(node) ? 1 : -1;
+          affine = lhs.second;
+          for (auto& coeff : rhs.second.coeffs) {
+            affine.coeffs[coeff.first] += sign * coeff.second;
+          }
+          affine.constant += sign * rhs.second.constant;
+        } else {
+          // one of the factors must be a constant
+          if (!lhs.second.coeffs.empty()) std::swap(lhs, rhs);
+          if (!lhs.second.coeffs.empty()) form.first = false;
+          affine = rhs.second;
+          for (auto& coeff : affine.coeffs) coeff.second *= lhs.second.constant;
+          affine.constant *= lhs.second.constant;
+        }
+
+        for (auto it = affine.coeffs.begin(); it != affine.coeffs.end();) {
+          if (it->second == 0) {
+            it = affine.coeffs.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+      forms.push_back(form);
+    });
+
+    if (!forms.back().first) return false;
+    result = forms.back().second;
+    return true;
+  }
+
+  void DependenceAnalysis::addAccess(SgPntrArrRefExp* ref, bool write,
+                                     const std::vector<Loop*>& nest) {
+    // 'a[i][j]' is '(a[i])[j]'
+    Access access;
+    SgExpression* base = ref;
+    while (SgPntrArrRefExp* arrRef = dynamic_cast<SgPntrArrRefExp*>(base)) {
+      access.subscripts.insert(access.subscripts.begin(), arrRef->get_rhs_operand());
+      base = arrRef->get_lhs_operand();
+    }
+
+    SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(base);
+    if (var == nullptr) return;
+
+    access.array = var->get_symbol()->get_name().getString();
+    access.text = toString(ref);
+    access.write = write;
+
+    // an array parameter is a pointer
+    SgType* type = var->get_type();
+    SgInitializedName* decl = var->get_symbol()->get_declaration();
+    bool param = decl != nullptr && dynamic_cast<SgFunctionParameterList*>(decl->get_parent());
+    access.object = !param && type->stripTypedefsAndModifiers()->variantT() == T_ARRAY;
+    access.restricted = SageInterface::isRestrictType(type);
+    access.nest = nest;
+
+    std::string key = access.text + (write ? " write " : " read ") + nest.back()->getName();
+    if (collected.insert(key).second) {
+      accesses.push_back(access);
+    }
+  }
+
+  bool DependenceAnalysis::mayAlias(const Access& a, const Access& b) {
+    return !(a.object && b.object) && !a.restricted && !b.restricted;
+  }
+
+  void DependenceAnalysis::collectReads(SgExpression* expr, const std::vector<Loop*>& nest) {
+    // 'a[i]' of 'a[i][j]' is part of that access, not one of its own,
+    // but arrays read in subscripts are
+    std::set<SgExpression*> inner;
+    ASTHelper::traverse(expr, [&](SgExpression* node) {
+      SgPntrArrRefExp* ref = dynamic_cast<SgPntrArrRefExp*>(node);
+      if (ref != nullptr && inner.count(ref) == 0) {
+        addAccess(ref, false, nest);
+        for (SgExpression* base = ref->get_lhs_operand();
+             dynamic_cast<SgPntrArrRefExp*>(base);
+             base = dynamic_cast<SgPntrArrRefExp*>(base)->get_lhs_operand()) {
+          inner.insert(base);
+        }
+      }
+      return true;
+    });
+  }
+
+  void DependenceAnalysis::collectAccesses(Loop* loop, std::vector<Loop*>& nest) {
+    if (std::find(nest.begin(), nest.end(), loop) != nest.end()) return;
+
+    nest.push_back(loop);
+    findInductions(loop);
+
+    // variables declared in a loop are bound again in every iteration
+    VariableTable* decls = loop->getVariableTable();
+    for (auto it = decls->begin(), ie = decls->end(); it != ie; ++it) {
+      modified.insert(it->first);
+      declared.insert(it->first);
+    }
+
+    for (LoopPath* path : *loop) {
+      ConstraintList* cl = path->getConstraintList();
+      for (SgExpression* constraint : *cl) {
+        collectReads(constraint, nest);
+      }
+
+      VariableTable* varTbl = path->getVariableTable();
+      for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+        Variable* var = it->second;
+        collectReads(var->getValue(), nest);
+        if (ASTHelper::isPlainName(it->first)) {
+          modified.insert(it->first);
+          continue;
+        }
+
+        SgPntrArrRefExp* target = dynamic_cast<SgPntrArrRefExp*>(var->getTarget());
+        if (target != nullptr) {
+          addAccess(target, true, nest);
+          collectReads(target->get_lhs_operand(), nest);
+          collectReads(target->get_rhs_operand(), nest);
+          continue;
+        }
+
+        // a write through a pointer may touch any element
+        Dependence dep;
+        dep.kind = "unknown";
+        dep.array = ASTHelper::getBaseName(it->first);
+        dep.source = dep.sink = it->first;
+        dep.distance.assign(nest.size(), "*");
+        dep.direction.assign(nest.size(), "*");
+        dep.level = 1;
+        unknown.push_back(dep);
+      }
+    }
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      collectAccesses(inner, nest);
+    }
+    nest.pop_back();
+  }
+
+  bool DependenceAnalysis::test(const Access& src, const Access& sink,
+                                Dependence& dep) const {
+    size_t depth = 0;
+    while (depth < src.nest.size() && depth < sink.nest.size() &&
+           src.nest[depth] == sink.nest[depth]) {
+      ++depth;
+    }
+
+    // known distances by level
+    std::map<int, long> distances;
+    size_t dims = src.subscripts.size();
+    if (dims != sink.subscripts.size()) dims = 0;
+
+    for (size_t k = 0; k < dims; ++k) {
+      Affine a, b;
+      if (!toAffine(src.subscripts[k], a) || !toAffine(sink.subscripts[k], b)) {
+        continue;
+      }
+
+      // invariant variables must be the same on both sides
+      std::map<std::string, long> va, vb, sa, sb;
+      for (auto& coeff : a.coeffs) {
+        (isInduction(coeff.first) ? va : sa)[coeff.first] = coeff.second;
+      }
+      for (auto& coeff : b.coeffs) {
+        (isInduction(coeff.first) ? vb : sb)[coeff.first] = coeff.second;
+      }
+      if (sa != sb) continue;
+
+      // ZIV
+      if (va.empty() && vb.empty()) {
+        if (a.constant != b.constant) return false;
+        continue;
+      }
+
+      // strong SIV: a * i + c1 == a * i' + c2, i' - i == (c1 - c2) / a
+      if (va.size() == 1 && va == vb) {
+        const std::string& name = va.begin()->first;
+        int level = getLevel(name, src.nest, depth);
+        if (level >= 0) {
+          long diff = a.constant - b.constant;
+          long coeff = va.begin()->second;
+          if (diff % coeff != 0) return false;
+
+          long step = inductions.at(src.nest[level]).at(name);
+          if ((diff / coeff) % step != 0) return false;
+
+          long distance = diff / coeff / step;
+          auto iter = distances.find(level);
+          if (iter != distances.end() && iter->second != distance) return false;
+          distances[level] = distance;
+          continue;
+        }
+      }
+
+      // GCD
+      long g = 0;
+      for (auto& coeff : va) g = gcd(g, coeff.second);
+      for (auto& coeff : vb) g = gcd(g, coeff.second);
+      if (g != 0 && (b.constant - a.constant) % g != 0) return false;
+    }
+
+    std::vector<long> dist(depth, 0);
+    std::vector<std::string> dirs(depth, "*");
+    for (auto& distance : distances) {
+      dist[distance.first] = distance.second;
+      dirs[distance.first] = distance.second > 0 ? "<" : (distance.second < 0 ? ">" : "=");
+    }
+
+    size_t level = 0;
+    while (level < depth && dirs[level] == "=") ++level;
+
+    // same iteration
+    if (level == depth) return false;
+
+    // the sink runs first, reverse the dependence
+    bool reversed = dirs[level] == ">";
+    if (reversed) {
+      for (size_t i = 0; i < depth; ++i) {
+        dist[i] = -dist[i];
+        if (dirs[i] == "<") {
+          dirs[i] = ">";
+        } else if (dirs[i] == ">") {
+          dirs[i] = "<";
+        }
+      }
+    }
+
+    const Access& first = reversed ? sink : src;
+    const Access& second = reversed ? src : sink;
+    dep.kind = getKind(first.write, second.write);
+    dep.array = src.array;
+    dep.source = first.text;
+    dep.sink = second.text;
+    dep.direction = dirs;
+    dep.distance.clear();
+    for (size_t i = 0; i < depth; ++i) {
+      dep.distance.push_back(dirs[i] == "*" ? "*" : std::to_string(dist[i]));
+    }
+    dep.level = level + 1;
+    return true;
+  }
+
+  void DependenceAnalysis::analyzeLoop(Loop* loop) {
+    std::vector<Loop*> nest;
+    collectAccesses(loop, nest);
+
+    std::vector<Dependence> deps = unknown;
+    std::set<std::string> printed;
+    for (size_t i = 0; i < accesses.size(); ++i) {
+      for (size_t j = i; j < accesses.size(); ++j) {
+        const Access* src = &accesses[i];
+        const Access* sink = &accesses[j];
+        if (!src->write && !sink->write) continue;
+        if (!src->write) std::swap(src, sink);
+
+        Dependence dep;
+        if (src->array != sink->array) {
+          // a pointer may point into another array, at any element
+          if (!mayAlias(*src, *sink)) continue;
+          dep.kind = "unknown";
+          dep.array = src->array;
+          dep.source = src->text;
+          dep.sink = sink->text;
+          size_t depth = 0;
+          while (depth < src->nest.size() && depth < sink->nest.size() &&
+                 src->nest[depth] == sink->nest[depth]) {
+            ++depth;
+          }
+          dep.distance.assign(depth, "*");
+          dep.direction.assign(depth, "*");
+          dep.level = 1;
+        } else if (!test(*src, *sink, dep)) {
+          continue;
+        }
+
+        std::ostringstream key;
+        key << dep.kind << ' ' << dep.source << ' ' << dep.sink << ' ' << dep.level;
+        for (const std::string& d : dep.distance) key << ' ' << d;
+        if (printed.insert(key.str()).second) {
+          deps.push_back(dep);
+        }
+      }
+    }
+
+    // scalars updated by an iteration, except induction variables
+    // and variables declared in the nest
+    std::set<std::string> scalars;
+    for (const std::string& name : modified) {
+      if (declared.count(name) == 0 && !isInduction(name)) {
+        scalars.insert(name);
+      }
+    }
+
+    bool parallel = scalars.empty();
+    for (const Dependence& dep : deps) {
+      if (dep.level == 1) parallel = false;
+    }
+
+    loop->setInductionVars(inductions[loop]);
+    loop->setDependences(deps);
+    loop->setCarriedScalars(scalars);
+    loop->setParallel(parallel);
+  }
+
+  void DependenceAnalysis::analyze(Loop* loop) {
+    DependenceAnalysis analysis;
+    analysis.analyzeLoop(loop);
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      analyze(inner);
+    }
+  }
+
+}
@@ -0,0 +1,234 @@
+#include "diagnostics.h"
+#include "json.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace LE {
+
+  // counts of a kind of warning
+  struct KindCount {
+    long count;
+    long written;
+    // kept for the parent, not written yet
+    long deferred;
+    std::map<std::string, long> locations;
+    KindCount(): count(0), written(0), deferred(0) {}
+  };
+
+  static std::map<std::string, KindCount> kinds;
+
+  // in a worker, warnings to be written by the parent, as kind and location
+  static bool deferring = false;
+  static std::vector<std::pair<std::string, std::string>> pending;
+
+  // in a worker, warnings counted since the start of the current task
+  // and the pending ones before it, see Diagnostics::rollback
+  static std::vector<std::pair<std::string, std::string>> reported;
+  static size_t pendingMark = 0;
+
+  // warnings written for each kind, then only counted
+  static int writeLimit = 10;
+
+  // side file, -1 means stderr
+  static int sideFd = -1;
+
+  static bool summaryRegistered = false;
+
+  // make a message fit on one line
+  static std::string normalize(const std::string& message) {
+    std::string str = message;
+    std::replace(str.begin(), str.end(), '\n', ' ');
+    std::replace(str.begin(), str.end(), '\t', ' ');
+    size_t last = str.find_last_not_of(' ');
+    return last == std::string::npos ? "" : str.substr(0, last + 1);
+  }
+
+  // one write per line, so lines of forked workers appending
+  // to the same file never interleave
+  static void writeLine(const std::string& line) {
+    if (sideFd < 0) {
+      std::cerr << line << '\n';
+    } else {
+      std::string&& str = line + "\n";
+      ssize_t n = write(sideFd, str.data(), str.size());
+      (void)n;
+    }
+  }
+
+  static void summaryAtExit() {
+    Diagnostics::summary();
+  }
+
+  void Diagnostics::configure(const std::string& file, int limit) {
+    writeLimit = limit;
+    if (!file.empty()) {
+      sideFd = open(file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_TRUNC, 0644);
+      if (sideFd < 0) {
+        std::cerr << "LOOP EXTRACTION WARNING: can't open " << file
+                  << ", diagnostics go to stderr\n";
+      }
+    }
+    if (!summaryRegistered) {
+      summaryRegistered = true;
+      std::atexit(summaryAtExit);
+    }
+  }
+
+  // write a warning unless its kind is over limit
+  static void writeWarning(const std::string& kind, KindCount& kc, const std::string& location) {
+    // one more than limit is the note that the rest is only counted
+    if (kc.written > writeLimit) return;
+    if (++kc.written > writeLimit) {
+      if (sideFd < 0) {
+        writeLine("LOOP EXTRACTION WARNING: further '" + kind + "' are counted only");
+      }
+      return;
+    }
+
+    if (sideFd >= 0) {
+      std::ostringstream oss;
+      oss << "{\"kind\": " << jsonString(kind)
+          << ", \"location\": " << jsonString(location) << "}";
+      writeLine(oss.str());
+    } else if (location.empty()) {
+      writeLine("LOOP EXTRACTION WARNING: " + kind);
+    } else {
+      writeLine("LOOP EXTRACTION WARNING: " + location + ": " + kind);
+    }
+  }
+
+  void Diagnostics::report(const std::string& message, const std::string& location) {
+    if (!summaryRegistered) {
+      summaryRegistered = true;
+      std::atexit(summaryAtExit);
+    }
+
+    std::string&& kind = normalize(message);
+    KindCount& kc = kinds[kind];
+    ++kc.count;
+    ++kc.locations[location];
+
+    if (!deferring) {
+      writeWarning(kind, kc, location);
+      return;
+    }
+
+    reported.push_back(std::make_pair(kind, location));
+    if (kc.written + kc.deferred <= writeLimit) {
+      // one more than limit, so that the parent notes the rest is only counted
+      ++kc.deferred;
+      pending.push_back(std::make_pair(kind, location));
+    }
+  }
+
+  // a line per warning to write: 'w', kind and location separated by tabs,
+  // in the order they were reported
+  // then a line per kind and location: count, kind and location
+  std::string Diagnostics::serialize() {
+    std::ostringstream oss;
+    for (auto& p : pending) {
+      oss << "w\t" << p.first << '\t' << p.second << '\n';
+    }
+    for (auto& k : kinds) {
+      for (auto& l : k.second.locations) {
+        if (l.second == 0) continue;
+        oss << l.second << '\t' << k.first << '\t' << l.first << '\n';
+      }
+    }
+    return oss.str();
+  }
+
+  void Diagnostics::merge(const std::string& counts) {
+    std::istringstream iss(counts);
+    std::string line;
+    while (std::getline(iss, line)) {
+      size_t tab1 = line.find('\t');
+      size_t tab2 = tab1 == std::string::npos ? tab1 : line.find('\t', tab1 + 1);
+      if (tab2 == std::string::npos) continue;
+
+      std::string&& kind = line.substr(tab1 + 1, tab2 - tab1 - 1);
+      KindCount& kc = kinds[kind];
+      if (line.compare(0, tab1, "w") == 0) {
+        writeWarning(kind, kc, line.substr(tab2 + 1));
+        continue;
+      }
+
+      long count = std::strtol(line.substr(0, tab1).c_str(), nullptr, 10);
+      kc.count += count;
+      kc.locations[line.substr(tab2 + 1)] += count;
+    }
+  }
+
+  void Diagnostics::reset() {
+    for (auto& k : kinds) {
+      k.second.count = 0;
+      k.second.deferred = 0;
+      k.second.locations.clear();
+    }
+    pending.clear();
+  }
+
+  void Diagnostics::defer() {
+    deferring = true;
+  }
+
+  void Diagnostics::mark() {
+    reported.clear();
+    pendingMark = pending.size();
+  }
+
+  void Diagnostics::rollback() {
+    for (auto& r : reported) {
+      KindCount& kc = kinds[r.first];
+      --kc.count;
+      --kc.locations[r.second];
+    }
+    for (size_t i = pendingMark; i < pending.size(); ++i) {
+      --kinds[pending[i].first].deferred;
+    }
+    pending.resize(pendingMark);
+    reported.clear();
+  }
+
+  void Diagnostics::summary() {
+    std::vector<std::pair<std::string, KindCount*>> sorted;
+    for (auto& k : kinds) {
+      if (k.second.count == 0) continue;
+      sorted.push_back(std::make_pair(k.first, &k.second));
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+      [](const std::pair<std::string, KindCount*>& a, const std::pair<std::string, KindCount*>& b) {
+        return a.second->count > b.second->count;
+      });
+    if (sorted.empty()) return;
+
+    if (sideFd < 0) {
+      writeLine("LOOP EXTRACTION DIAGNOSTICS SUMMARY");
+      writeLine("      count  locations  kind");
+    }
+    for (auto& k : sorted) {
+      // locations known, the empty location doesn't count
+      long locations = k.second->locations.size() - k.second->locations.count("");
+      char buffer[64];
+      if (sideFd < 0) {
+        std::snprintf(buffer, sizeof(buffer), "%11ld  %9ld  ", k.second->count, locations);
+        writeLine(buffer + k.first);
+      } else {
+        std::snprintf(buffer, sizeof(buffer), ", \"count\": %ld, \"locations\": %ld}",
+                      k.second->count, locations);
+        writeLine("{\"summary\": " + jsonString(k.first) + buffer);
+      }
+    }
+    kinds.clear();
+  }
+
+}
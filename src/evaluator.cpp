@@ -0,0 +1,774 @@
+#include "evaluator.h"
+#include "astHelper.h"
+#include "message.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <set>
+#include <sstream>
+
+namespace LE {
+
+  // values of all variables and the stack for a batch of evaluations
+  // a batch is wide enough for the compiler to vectorize every operation
+  class Batch {
+  public:
+    static const size_t width = 256;
+
+    // masks, choices and values of lanes choosing paths
+    struct Lanes {
+      std::vector<char> active;
+      std::vector<char> sub;
+      std::vector<char> ok;
+      std::vector<int> choice;
+      std::vector<double> value;
+
+      Lanes(): active(width, 0), sub(width, 0), ok(width, 0), choice(width, -1), value(width) {}
+    };
+
+    // number of lanes in use
+    size_t n;
+
+    // slot-major, value of slot s in lane l is regs[s * width + l]
+    std::vector<double> regs;
+    std::vector<double> stack;
+    std::vector<double> scratch;
+
+    // regs at the start of a region, a lane tries each path from there
+    std::vector<double> saved;
+
+    // lanes whose loop did not terminate or matched no path
+    std::vector<char> failed;
+
+    // lanes of the paths of the function, and of each loop
+    // a loop never runs inside itself, so its lanes are never shared
+    Lanes paths;
+    std::vector<Lanes> loops;
+
+    // every lane set
+    std::vector<char> all;
+
+    Batch(size_t slots, size_t depth, size_t nLoops):
+      n(0), regs(slots * width, 0.0), stack(depth * width), saved(slots * width),
+      failed(width, 0), loops(nLoops), all(width, 1) {}
+
+    inline double* reg(int slot) { return &regs[slot * width]; }
+  };
+
+  const size_t Batch::width;
+
+  // convert to integer for bitwise operators
+  // values out of range (including NaN) become 0
+  static inline long long toInt(double x) {
+    return (x > -9.2e18 && x < 9.2e18) ? static_cast<long long>(x) : 0;
+  }
+
+  // ------------------------- evaluation ----------------------------------//
+
+  #define BINARY_OP(expr) { \
+      double* a = base + (sp - 2) * w; \
+      const double* b = a + w; \
+      for (size_t l = 0; l < n; ++l) { a[l] = (expr); } \
+      --sp; \
+      break; \
+    }
+
+  #define UNARY_OP(expr) { \
+      double* a = base + (sp - 1) * w; \
+      for (size_t l = 0; l < n; ++l) { a[l] = (expr); } \
+      break; \
+    }
+
+  void CompiledFunction::run(const Code& code, Batch& batch, double* out) const {
+    const size_t w = Batch::width, n = batch.n;
+    double* base = batch.stack.data();
+    size_t sp = 0;
+
+    for (const Instruction& ins : code) {
+      switch (ins.op) {
+        case OP_CONST: {
+          double* a = base + sp * w;
+          for (size_t l = 0; l < n; ++l) a[l] = ins.value;
+          ++sp;
+          break;
+        }
+        case OP_LOAD: {
+          double* a = base + sp * w;
+          const double* r = batch.reg(ins.slot);
+          for (size_t l = 0; l < n; ++l) a[l] = r[l];
+          ++sp;
+          break;
+        }
+        case OP_POP: --sp; break;
+        case OP_ADD: BINARY_OP(a[l] + b[l])
+        case OP_SUB: BINARY_OP(a[l] - b[l])
+        case OP_MUL: BINARY_OP(a[l] * b[l])
+        case OP_DIV: BINARY_OP(a[l] / b[l])
+        case OP_IDIV: BINARY_OP(std::trunc(a[l] / b[l]))
+        case OP_MOD: BINARY_OP(std::fmod(a[l], b[l]))
+        case OP_LT: BINARY_OP(a[l] < b[l] ? 1.0 : 0.0)
+        case OP_GT: BINARY_OP(a[l] > b[l] ? 1.0 : 0.0)
+        case OP_LE: BINARY_OP(a[l] <= b[l] ? 1.0 : 0.0)
+        case OP_GE: BINARY_OP(a[l] >= b[l] ? 1.0 : 0.0)
+        case OP_EQ: BINARY_OP(a[l] == b[l] ? 1.0 : 0.0)
+        case OP_NE: BINARY_OP(a[l] != b[l] ? 1.0 : 0.0)
+        case OP_AND: BINARY_OP((a[l] != 0 && b[l] != 0) ? 1.0 : 0.0)
+        case OP_OR: BINARY_OP((a[l] != 0 || b[l] != 0) ? 1.0 : 0.0)
+        case OP_BITAND: BINARY_OP(static_cast<double>(toInt(a[l]) & toInt(b[l])))
+        case OP_BITOR: BINARY_OP(static_cast<double>(toInt(a[l]) | toInt(b[l])))
+        case OP_BITXOR: BINARY_OP(static_cast<double>(toInt(a[l]) ^ toInt(b[l])))
+        case OP_SHL: BINARY_OP(static_cast<double>(static_cast<long long>(
+          static_cast<unsigned long long>(toInt(a[l])) << (toInt(b[l]) & 63))))
+        case OP_SHR: BINARY_OP(static_cast<double>(toInt(a[l]) >> (toInt(b[l]) & 63)))
+        case OP_NOT: UNARY_OP(a[l] == 0 ? 1.0 : 0.0)
+        case OP_NEG: UNARY_OP(-a[l])
+        case OP_BITNOT: UNARY_OP(static_cast<double>(~toInt(a[l])))
+        case OP_TRUNC: UNARY_OP(std::trunc(a[l]))
+        case OP_SELECT: {
+          double* c = base + (sp - 3) * w;
+          const double* a = c + w;
+          const double* b = a + w;
+          for (size_t l = 0; l < n; ++l) { c[l] = c[l] != 0 ? a[l] : b[l]; }
+          sp -= 2;
+          break;
+        }
+      }
+    }
+
+    const double* a = base;
+    for (size_t l = 0; l < n; ++l) out[l] = a[l];
+  }
+
+  #undef BINARY_OP
+  #undef UNARY_OP
+
+  void CompiledFunction::apply(const CompiledUpdate* updates, size_t count,
+                               const char* mask, Batch& batch) const {
+    const size_t w = Batch::width, n = batch.n;
+    if (batch.scratch.size() < count * w) {
+      batch.scratch.resize(count * w);
+    }
+
+    // all values are computed before any variable is written
+    for (size_t i = 0; i < count; ++i) {
+      run(updates[i].code, batch, &batch.scratch[i * w]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      double* r = batch.reg(updates[i].slot);
+      const double* v = &batch.scratch[i * w];
+      if (integral[updates[i].slot]) {
+        for (size_t l = 0; l < n; ++l) r[l] = mask[l] ? std::trunc(v[l]) : r[l];
+      } else {
+        for (size_t l = 0; l < n; ++l) r[l] = mask[l] ? v[l] : r[l];
+      }
+    }
+  }
+
+  void CompiledFunction::runLoop(int index, const char* mask, Batch& batch) const {
+    const CompiledLoop& loop = loops[index];
+    const size_t n = batch.n;
+
+    // variables declared in the loop are initialized one after another
+    for (const CompiledUpdate& update : loop.init) {
+      apply(&update, 1, mask, batch);
+    }
+
+    Batch::Lanes& lanes = batch.loops[index];
+    std::vector<char>& active = lanes.active;
+    std::vector<char>& sub = lanes.sub;
+    std::vector<char>& ok = lanes.ok;
+    std::vector<int>& choice = lanes.choice;
+    std::vector<double>& value = lanes.value;
+    std::copy(mask, mask + n, active.begin());
+
+    for (long iter = 0; ; ++iter) {
+      bool any = false;
+      for (size_t l = 0; l < n; ++l) any |= active[l] != 0;
+      if (!any) break;
+
+      if (iter >= maxIterations) {
+        for (size_t l = 0; l < n; ++l) {
+          if (active[l]) batch.failed[l] = 1;
+        }
+        break;
+      }
+
+      // choose the first loop path whose constraints hold
+      for (size_t l = 0; l < n; ++l) choice[l] = -1;
+      for (size_t q = 0; q < loop.paths.size(); ++q) {
+        for (size_t l = 0; l < n; ++l) ok[l] = active[l] && choice[l] < 0;
+        for (const Code& constraint : loop.paths[q].constraints) {
+          run(constraint, batch, value.data());
+          for (size_t l = 0; l < n; ++l) ok[l] = ok[l] && value[l] != 0;
+        }
+        for (size_t l = 0; l < n; ++l) {
+          if (ok[l]) choice[l] = q;
+        }
+      }
+
+      for (size_t l = 0; l < n; ++l) {
+        if (active[l] && choice[l] < 0) {
+          batch.failed[l] = 1;
+          active[l] = 0;
+        }
+      }
+
+      for (size_t q = 0; q < loop.paths.size(); ++q) {
+        bool taken = false;
+        for (size_t l = 0; l < n; ++l) {
+          sub[l] = active[l] && choice[l] == (int)q;
+          taken |= sub[l] != 0;
+        }
+        if (!taken) continue;
+
+        const CompiledLoopPath& path = loop.paths[q];
+        apply(path.updates, sub.data(), batch);
+        for (int inner : path.innerLoops) {
+          runLoop(inner, sub.data(), batch);
+        }
+      }
+
+      for (size_t l = 0; l < n; ++l) {
+        if (active[l] && loop.paths[choice[l]].canBreak) active[l] = 0;
+      }
+    }
+  }
+
+  void CompiledFunction::load(const std::vector<const double*>& in,
+                              const std::vector<const double*>& free, size_t offset,
+                              Batch& batch) const {
+    const size_t n = batch.n;
+    std::fill(batch.regs.begin(), batch.regs.end(), 0.0);
+    std::fill(batch.failed.begin(), batch.failed.end(), 0);
+
+    for (size_t k = 0; k < inputSlots.size(); ++k) {
+      double* r = batch.reg(inputSlots[k]);
+      const double* v = in[k] + offset;
+      bool isInt = integral[inputSlots[k]];
+      for (size_t l = 0; l < n; ++l) r[l] = isInt ? std::trunc(v[l]) : v[l];
+    }
+    for (size_t k = 0; k < free.size(); ++k) {
+      double* r = batch.reg(freeSlots[k]);
+      const double* v = free[k] + offset;
+      bool isInt = integral[freeSlots[k]];
+      for (size_t l = 0; l < n; ++l) r[l] = isInt ? std::trunc(v[l]) : v[l];
+    }
+
+    for (const CompiledUpdate& update : init) {
+      apply(&update, 1, batch.all.data(), batch);
+    }
+  }
+
+  bool CompiledFunction::tryPath(size_t p, char* mask, Batch& batch) const {
+    const CompiledPath& path = paths[p];
+    const size_t n = batch.n;
+    double* value = batch.paths.value.data();
+    bool ran = false;
+
+    size_t c = 0;
+    for (size_t s = 0; ; ++s) {
+      // constraints checked after s steps
+      for (; c < path.constraints.size() && path.constraintSteps[c] == s; ++c) {
+        run(path.constraints[c], batch, value);
+        for (size_t l = 0; l < n; ++l) mask[l] = mask[l] && value[l] != 0;
+      }
+      if (s == path.steps.size()) break;
+
+      bool any = false;
+      for (size_t l = 0; l < n; ++l) any |= mask[l] != 0;
+      if (!any) break;
+
+      const CompiledStep& step = path.steps[s];
+      if (step.isLoop) {
+        runLoop(step.index, mask, batch);
+      } else {
+        apply(blocks[step.index], mask, batch);
+      }
+      ran = true;
+
+      // a lane whose loop did not terminate never gets further
+      for (size_t l = 0; l < n; ++l) {
+        if (batch.failed[l]) mask[l] = 0;
+      }
+    }
+    return ran;
+  }
+
+  void CompiledFunction::evaluateBatch(const std::vector<const double*>& in,
+                                       const std::vector<const double*>& free, size_t offset,
+                                       Batch& batch, double* results, int* chosen,
+                                       std::vector<long>* witnesses) const {
+    const size_t w = Batch::width, n = batch.n;
+    load(in, free, offset, batch);
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (size_t l = 0; l < n; ++l) results[l] = nan;
+
+    // active: lanes that haven't returned yet
+    // ok: lanes that haven't taken a path of the region yet
+    Batch::Lanes& lanes = batch.paths;
+    std::vector<char>& active = lanes.active;
+    std::vector<char>& ok = lanes.ok;
+    std::vector<char>& sub = lanes.sub;
+    std::vector<int>& choice = lanes.choice;
+    std::vector<double>& value = lanes.value;
+    std::fill(active.begin(), active.end(), 0);
+    std::fill(active.begin(), active.begin() + n, 1);
+    std::fill(choice.begin(), choice.end(), -1);
+
+    size_t begin = 0;
+    for (size_t r = 0; r < regionEnds.size(); ++r) {
+      const size_t end = regionEnds[r];
+      const bool last = r + 1 == regionEnds.size();
+
+      // take the first path of the region whose constraints hold,
+      // a lane that fails a constraint after some steps of a path
+      // tries the next path from the values at the start of the region
+      std::copy(batch.regs.begin(), batch.regs.end(), batch.saved.begin());
+      std::copy(active.begin(), active.end(), ok.begin());
+      bool changed = false;
+      for (size_t p = begin; p < end; ++p) {
+        bool any = false;
+        for (size_t l = 0; l < n; ++l) {
+          sub[l] = ok[l];
+          any |= sub[l] != 0;
+        }
+        if (!any) break;
+
+        if (changed) {
+          for (size_t s = 0; s < integral.size(); ++s) {
+            double* reg = batch.reg(s);
+            const double* saved = &batch.saved[s * w];
+            for (size_t l = 0; l < n; ++l) reg[l] = sub[l] ? saved[l] : reg[l];
+          }
+        }
+        changed = tryPath(p, sub.data(), batch);
+
+        // a lane whose loop did not terminate stays NaN
+        for (size_t l = 0; l < n; ++l) {
+          if (ok[l] && batch.failed[l]) ok[l] = active[l] = 0;
+          if (sub[l]) {
+            ok[l] = 0;
+            choice[l] = p;
+            if (witnesses != nullptr && (*witnesses)[p] < 0) (*witnesses)[p] = offset + l;
+          }
+        }
+
+        const CompiledPath& path = paths[p];
+        if (!path.isReturn && !last) continue;
+
+        if (path.retVal.empty()) {
+          for (size_t l = 0; l < n; ++l) value[l] = 0;
+        } else {
+          run(path.retVal, batch, value.data());
+        }
+        for (size_t l = 0; l < n; ++l) {
+          if (sub[l]) {
+            results[l] = value[l];
+            active[l] = 0;
+          }
+        }
+      }
+
+      // lanes that matched no path
+      for (size_t l = 0; l < n; ++l) {
+        if (ok[l]) {
+          choice[l] = -1;
+          active[l] = 0;
+        }
+      }
+      begin = end;
+    }
+
+    if (chosen != nullptr) {
+      for (size_t l = 0; l < n; ++l) chosen[l] = choice[l];
+    }
+  }
+
+  void CompiledFunction::evaluate(const std::vector<const double*>& in, size_t n,
+                                  double* results, int* chosen) const {
+    assert(in.size() == inputs.size() && "wrong number of inputs");
+    Batch batch(integral.size(), maxDepth, loops.size());
+    for (size_t offset = 0; offset < n; offset += Batch::width) {
+      batch.n = n - offset < Batch::width ? n - offset : Batch::width;
+      evaluateBatch(in, std::vector<const double*>(), offset, batch, results + offset,
+                    chosen == nullptr ? nullptr : chosen + offset, nullptr);
+    }
+  }
+
+  size_t CompiledFunction::findWitnesses(const std::vector<const double*>& in,
+                                         const std::vector<const double*>& free, size_t n,
+                                         std::vector<long>& witnesses) const {
+    assert(in.size() == inputs.size() && "wrong number of inputs");
+    assert((free.empty() || free.size() == freeVars.size()) && "wrong number of free variables");
+    witnesses.resize(paths.size(), -1);
+    size_t missing = std::count(witnesses.begin(), witnesses.end(), -1);
+
+    // a witness must take its path, not only satisfy its constraints,
+    // so the whole function is evaluated
+    Batch batch(integral.size(), maxDepth, loops.size());
+    std::vector<double> results(Batch::width);
+    for (size_t offset = 0; offset < n && missing > 0; offset += Batch::width) {
+      batch.n = n - offset < Batch::width ? n - offset : Batch::width;
+      evaluateBatch(in, free, offset, batch, results.data(), nullptr, &witnesses);
+      missing = std::count(witnesses.begin(), witnesses.end(), -1);
+    }
+    return missing;
+  }
+
+  // ------------------------- compilation ---------------------------------//
+
+  int Evaluator::getSlot(const std::string& name) {
+    auto iter = slots.find(name);
+    if (iter != slots.end()) return iter->second;
+
+    int slot = result->integral.size();
+    slots[name] = slot;
+    result->integral.push_back(false);
+    return slot;
+  }
+
+  void Evaluator::setIntegral(int slot, VariantT type) {
+    result->integral[slot] = ASTHelper::isIntegralType(type);
+  }
+
+  void Evaluator::compileExpr(SgExpression* expr, Code& code) {
+    // expressions left to compile and instructions left to emit, the next
+    // one last, in place of recursion over deeply nested expressions
+    struct Step {
+      SgExpression* expr;
+      bool emit;
+      Instruction ins;
+    };
+    std::vector<Step> steps(1, Step{expr, false, Instruction(OP_POP)});
+    auto compile = [&](SgExpression* e) { steps.push_back(Step{e, false, Instruction(OP_POP)}); };
+    auto emit = [&](const Instruction& ins) { steps.push_back(Step{nullptr, true, ins}); };
+
+    while (!steps.empty() && error.empty()) {
+      Step step = steps.back();
+      steps.pop_back();
+      if (step.emit) {
+        code.push_back(step.ins);
+        continue;
+      }
+
+      SgExpression* expr = step.expr;
+      if (expr == nullptr) {
+        error = "missing expression";
+        continue;
+      }
+
+      if (SgBoolValExp* boolVal = dynamic_cast<SgBoolValExp*>(expr)) {
+        code.push_back(Instruction(OP_CONST, 0, boolVal->get_value() ? 1 : 0));
+        continue;
+      }
+
+      if (SgValueExp* value = dynamic_cast<SgValueExp*>(expr)) {
+        std::string&& str = value->get_constant_folded_value_as_string();
+        char* end = nullptr;
+        double v = std::strtod(str.c_str(), &end);
+        if (str.empty() || *end != '\0') {
+          error = "constant '" + str + "'";
+          continue;
+        }
+        code.push_back(Instruction(OP_CONST, 0, v));
+        continue;
+      }
+
+      if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr)) {
+        code.push_back(Instruction(OP_LOAD, getSlot(var->get_symbol()->get_name().getString())));
+        continue;
+      }
+
+      if (SgAssignInitializer* initializer = dynamic_cast<SgAssignInitializer*>(expr)) {
+        compile(initializer->get_operand());
+        continue;
+      }
+
+      // both branches are evaluated, summaries have no side effects
+      if (SgConditionalExp* condExp = dynamic_cast<SgConditionalExp*>(expr)) {
+        emit(Instruction(OP_SELECT));
+        compile(condExp->get_false_exp());
+        compile(condExp->get_true_exp());
+        compile(condExp->get_conditional_exp());
+        continue;
+      }
+
+      if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+        OpCode op;
+        switch (binOp->variantT()) {
+          case V_SgAddOp: op = OP_ADD; break;
+          case V_SgSubtractOp: op = OP_SUB; break;
+          case V_SgMultiplyOp: op = OP_MUL; break;
+          case V_SgDivideOp: op = ASTHelper::isIntegralType(binOp->get_type()) ? OP_IDIV : OP_DIV; break;
+          case V_SgIntegerDivideOp: op = OP_IDIV; break;
+          case V_SgModOp: op = OP_MOD; break;
+          case V_SgLessThanOp: op = OP_LT; break;
+          case V_SgGreaterThanOp: op = OP_GT; break;
+          case V_SgLessOrEqualOp: op = OP_LE; break;
+          case V_SgGreaterOrEqualOp: op = OP_GE; break;
+          case V_SgEqualityOp: op = OP_EQ; break;
+          case V_SgNotEqualOp: op = OP_NE; break;
+          case V_SgAndOp: op = OP_AND; break;
+          case V_SgOrOp: op = OP_OR; break;
+          case V_SgBitAndOp: op = OP_BITAND; break;
+          case V_SgBitOrOp: op = OP_BITOR; break;
+          case V_SgBitXorOp: op = OP_BITXOR; break;
+          case V_SgLshiftOp: op = OP_SHL; break;
+          case V_SgRshiftOp: op = OP_SHR; break;
+          case V_SgCommaOpExp: op = OP_POP; break;
+          default:
+            error = expr->class_name();
+            continue;
+        }
+
+        if (op == OP_POP) {
+          // value of a comma expression is its right operand
+          compile(binOp->get_rhs_operand());
+          emit(Instruction(OP_POP));
+        } else {
+          emit(Instruction(op));
+          compile(binOp->get_rhs_operand());
+        }
+        compile(binOp->get_lhs_operand());
+        continue;
+      }
+
+      if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(expr)) {
+        switch (unaryOp->variantT()) {
+          case V_SgPlusPlusOp:
+            emit(Instruction(OP_ADD));
+            emit(Instruction(OP_CONST, 0, 1));
+            break;
+          case V_SgMinusMinusOp:
+            emit(Instruction(OP_SUB));
+            emit(Instruction(OP_CONST, 0, 1));
+            break;
+          case V_SgNotOp: emit(Instruction(OP_NOT)); break;
+          case V_SgMinusOp: emit(Instruction(OP_NEG)); break;
+          case V_SgBitComplementOp: emit(Instruction(OP_BITNOT)); break;
+          case V_SgUnaryAddOp: break;
+          case V_SgCastExp:
+            if (ASTHelper::isIntegralType(unaryOp->get_type())) {
+              emit(Instruction(OP_TRUNC));
+            }
+            break;
+          default:
+            error = expr->class_name();
+            continue;
+        }
+        compile(unaryOp->get_operand());
+        continue;
+      }
+
+      error = expr->class_name();
+    }
+  }
+
+  Code Evaluator::compileCode(SgExpression* expr) {
+    Code code;
+    compileExpr(expr, code);
+
+    // track depth of stack
+    size_t depth = 0;
+    for (const Instruction& ins : code) {
+      switch (ins.op) {
+        case OP_CONST: case OP_LOAD: ++depth; break;
+        case OP_NOT: case OP_NEG: case OP_BITNOT: case OP_TRUNC: break;
+        case OP_SELECT: depth -= 2; break;
+        default: --depth;
+      }
+      if (depth > result->maxDepth) result->maxDepth = depth;
+    }
+    return code;
+  }
+
+  std::vector<CompiledUpdate> Evaluator::compileUpdates(VariableTable* varTbl) {
+    std::vector<CompiledUpdate> updates;
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      if (!ASTHelper::isPlainName(it->first)) {
+        error = "update of '" + it->first + "'";
+        return updates;
+      }
+
+      CompiledUpdate update;
+      update.slot = getSlot(it->first);
+      update.code = compileCode(it->second->getValue());
+      updates.push_back(update);
+    }
+    return updates;
+  }
+
+  int Evaluator::compileLoop(Loop* loop) {
+    auto iter = loopIndex.find(loop->getName());
+    if (iter != loopIndex.end()) return iter->second;
+
+    int index = result->loops.size();
+    result->loops.push_back(CompiledLoop());
+    loopIndex[loop->getName()] = index;
+
+    CompiledLoop compiled;
+    VariableTable* varTbl = loop->getVariableTable();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      Variable* var = it->second;
+      int slot = getSlot(it->first);
+      setIntegral(slot, var->getType());
+      if (var->getInitValue() != nullptr) {
+        CompiledUpdate update;
+        update.slot = slot;
+        update.code = compileCode(var->getInitValue());
+        compiled.init.push_back(update);
+      }
+    }
+
+    std::map<std::string, Loop*> innerLoops;
+    for (Loop* inner : loop->getInnerLoops()) {
+      innerLoops[inner->getName()] = inner;
+    }
+
+    for (LoopPath* path : *loop) {
+      CompiledLoopPath compiledPath;
+      for (SgExpression* constraint : *path->getConstraintList()) {
+        compiledPath.constraints.push_back(compileCode(constraint));
+      }
+      compiledPath.updates = compileUpdates(path->getVariableTable());
+      for (const std::string& name : path->getInnerLoops()) {
+        auto inner = innerLoops.find(name);
+        if (inner == innerLoops.end()) {
+          error = "unknown loop " + name;
+          continue;
+        }
+        compiledPath.innerLoops.push_back(compileLoop(inner->second));
+      }
+      compiledPath.canBreak = path->canBreakLoop();
+      compiled.paths.push_back(compiledPath);
+    }
+
+    result->loops[index] = compiled;
+    return index;
+  }
+
+  void Evaluator::compileFunction(Function* func) {
+    for (const std::string& param : func->getParams()) {
+      result->inputs.push_back(param);
+      result->inputSlots.push_back(getSlot(param));
+    }
+
+    // declarations have no position, initial values are computed on entry,
+    // which is wrong if they read a variable that is updated
+    std::set<std::string>&& updated = func->getUpdated();
+    VariableTable* varTbl = func->getVariableTable();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      Variable* var = it->second;
+      int slot = getSlot(it->first);
+      setIntegral(slot, var->getType());
+
+      std::set<std::string> reads;
+      ASTHelper::collectVarNames(var->getInitValue(), reads);
+      for (const std::string& read : reads) {
+        if (updated.count(read) > 0 && error.empty()) {
+          error = "initial value of '" + it->first + "' reading updated '" + read + "'";
+        }
+      }
+
+      if (var->getInitValue() != nullptr) {
+        CompiledUpdate update;
+        update.slot = slot;
+        update.code = compileCode(var->getInitValue());
+        result->init.push_back(update);
+      }
+    }
+
+    std::vector<Function*>&& scopes = func->getScopes();
+
+    std::map<std::string, int> blockIndex;
+    std::map<std::string, Loop*> loops;
+    for (Function* scope : scopes) {
+      for (Block* block : scope->getBlocks()) {
+        blockIndex[block->getName()] = result->blocks.size();
+        result->blocks.push_back(compileUpdates(block->getVariableTable()));
+      }
+      for (Loop* loop : scope->getLoops()) {
+        loops[loop->getName()] = loop;
+      }
+    }
+
+    for (Function* scope : scopes) {
+      compilePaths(scope, blockIndex, loops);
+      result->regionEnds.push_back(result->paths.size());
+    }
+
+    // variables neither passed nor initialized are free
+    std::set<int> assigned(result->inputSlots.begin(), result->inputSlots.end());
+    for (const CompiledUpdate& update : result->init) {
+      assigned.insert(update.slot);
+    }
+    for (const CompiledLoop& loop : result->loops) {
+      for (const CompiledUpdate& update : loop.init) {
+        assigned.insert(update.slot);
+      }
+    }
+    for (auto& slot : slots) {
+      if (!assigned.count(slot.second)) {
+        result->freeVars.push_back(slot.first);
+        result->freeSlots.push_back(slot.second);
+      }
+    }
+  }
+
+  void Evaluator::compilePaths(Function* scope, const std::map<std::string, int>& blockIndex,
+                               const std::map<std::string, Loop*>& loops) {
+    for (Path* path : scope->getPaths()) {
+      CompiledPath compiled;
+      compiled.name = path->getName();
+      compiled.isReturn = path->isPathReturn();
+      ConstraintList* cl = path->getConstraints();
+      for (size_t i = 0; i < cl->size(); ++i) {
+        compiled.constraints.push_back(compileCode(cl->get(i)));
+        compiled.constraintSteps.push_back(cl->getStep(i));
+      }
+
+      for (const std::string& element : path->getPaths()) {
+        CompiledStep step;
+        auto block = blockIndex.find(element);
+        auto loop = loops.find(element);
+        if (block != blockIndex.end()) {
+          step.isLoop = false;
+          step.index = block->second;
+        } else if (loop != loops.end()) {
+          step.isLoop = true;
+          step.index = compileLoop(loop->second);
+        } else {
+          error = "unknown block " + element;
+          continue;
+        }
+        compiled.steps.push_back(step);
+      }
+
+      if (path->getReturnValue() != nullptr) {
+        compiled.retVal = compileCode(path->getReturnValue());
+      }
+      result->paths.push_back(compiled);
+    }
+  }
+
+  CompiledFunction* Evaluator::compile(Function* func) {
+    Evaluator evaluator;
+    evaluator.compileFunction(func);
+
+    if (!evaluator.error.empty()) {
+      std::stringstream ss;
+      ss << "can't compile function " << func->getName() << ": "
+         << evaluator.error << " unsupported in Evaluator::compile\n";
+      Message::warning(ss.str());
+      delete evaluator.result;
+      return nullptr;
+    }
+
+    return evaluator.result;
+  }
+
+}
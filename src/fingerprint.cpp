@@ -0,0 +1,67 @@
+#include "fingerprint.h"
+#include "fnv.h"
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+namespace LE {
+
+  std::string Fingerprint::compute(SgFunctionDeclaration* funcDecl) {
+    uint64_t hash = fnvOffset;
+
+    // functions are hashed in the order they are first called
+    std::vector<SgDeclarationStatement*> functions(1, funcDecl);
+    std::set<SgDeclarationStatement*> seen(functions.begin(), functions.end());
+
+    for (size_t i = 0; i < functions.size(); ++i) {
+      // pre-order, with an explicit stack as in Printer::printExpression
+      std::vector<SgNode*> stack(1, functions[i]);
+      while (!stack.empty()) {
+        SgNode* node = stack.back();
+        stack.pop_back();
+        if (node == nullptr) {
+          hashString(hash, "");
+          continue;
+        }
+
+        hashString(hash, node->class_name());
+        if (SgFunctionDeclaration* decl = dynamic_cast<SgFunctionDeclaration*>(node)) {
+          hashString(hash, decl->get_name().getString());
+        } else if (SgInitializedName* name = dynamic_cast<SgInitializedName*>(node)) {
+          hashString(hash, name->get_name().getString());
+          hashString(hash, name->get_type()->unparseToString());
+        } else if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(node)) {
+          hashString(hash, var->get_symbol()->get_name().getString());
+        } else if (SgValueExp* value = dynamic_cast<SgValueExp*>(node)) {
+          hashString(hash, value->get_constant_folded_value_as_string());
+        } else if (SgCastExp* cast = dynamic_cast<SgCastExp*>(node)) {
+          hashString(hash, cast->get_type()->unparseToString());
+        } else if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(node)) {
+          // a callee defined in the same file is hashed after this function
+          SgFunctionDeclaration* decl = call->getAssociatedFunctionDeclaration();
+          SgDeclarationStatement* callee = nullptr;
+          if (decl != nullptr) {
+            hashString(hash, decl->get_name().getString());
+            callee = decl->get_definingDeclaration();
+          }
+          if (callee != nullptr && seen.insert(callee).second) {
+            functions.push_back(callee);
+          }
+        }
+
+        // the number of children makes the shape of the tree part of the hash
+        std::vector<SgNode*> children = node->get_traversalSuccessorContainer();
+        hashString(hash, std::to_string(children.size()));
+        for (auto it = children.rbegin(), ie = children.rend(); it != ie; ++it) {
+          stack.push_back(*it);
+        }
+      }
+    }
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+  }
+
+}
@@ -0,0 +1,148 @@
+#include "invariant.h"
+#include "astHelper.h"
+#include "printer.h"
+#include <sstream>
+
+namespace LE {
+
+  void InvariantAnalysis::collectModified(Loop* loop, std::set<Loop*>& visited) {
+    if (!visited.insert(loop).second) return;
+
+    // variables declared in a loop are bound again in every iteration
+    VariableTable* decls = loop->getVariableTable();
+    for (auto it = decls->begin(), ie = decls->end(); it != ie; ++it) {
+      modified.insert(it->first);
+    }
+
+    for (LoopPath* path : *loop) {
+      VariableTable* varTbl = path->getVariableTable();
+      for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+        modified.insert(ASTHelper::getBaseName(it->first));
+        if (!ASTHelper::isPlainName(it->first)) {
+          writesMemory = true;
+        }
+      }
+    }
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      collectModified(inner, visited);
+    }
+  }
+
+  bool InvariantAnalysis::isInvariant(SgExpression* expr) {
+    if (expr == nullptr) return true;
+
+    // operators are decided after their operands, which are memoized first
+    auto known = [&](SgExpression* operand) {
+      return operand == nullptr || invariant[operand];
+    };
+    ASTHelper::traverse(expr, [&](SgExpression* node) {
+      if (node == nullptr || invariant.count(node) > 0) return false;
+
+      if (dynamic_cast<SgValueExp*>(node)) {
+        invariant[node] = true;
+      } else if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(node)) {
+        std::string name = var->get_symbol()->get_name().getString();
+        invariant[node] = modified.find(name) == modified.end();
+      } else if (dynamic_cast<SgBinaryOp*>(node) || dynamic_cast<SgUnaryOp*>(node)) {
+        return true;
+      } else {
+        // e.g. function calls
+        invariant[node] = false;
+      }
+      return false;
+    }, [&](SgExpression* node) {
+      if (node == nullptr || invariant.count(node) > 0) return;
+
+      if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(node)) {
+        // a read through an array may see a write of another iteration
+        invariant[node] = !(writesMemory && dynamic_cast<SgPntrArrRefExp*>(binOp)) &&
+                          !dynamic_cast<SgAssignOp*>(binOp) &&
+                          !dynamic_cast<SgCompoundAssignOp*>(binOp) &&
+                          known(binOp->get_lhs_operand()) &&
+                          known(binOp->get_rhs_operand());
+      } else if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(node)) {
+        invariant[node] = !(writesMemory && dynamic_cast<SgPointerDerefExp*>(unaryOp)) &&
+                          known(unaryOp->get_operand());
+      }
+    });
+    return invariant[expr];
+  }
+
+  void InvariantAnalysis::collectInvariantExprs(SgExpression* expr,
+                                                std::vector<SgExpression*>& exprs,
+                                                std::set<std::string>& printed) {
+    ASTHelper::traverse(expr, [&](SgExpression* node) {
+      if (node == nullptr ||
+          dynamic_cast<SgValueExp*>(node) || dynamic_cast<SgVarRefExp*>(node)) {
+        return false;
+      }
+
+      if (isInvariant(node)) {
+        // a cast of a variable or a constant is not worth reporting
+        SgCastExp* castExp = dynamic_cast<SgCastExp*>(node);
+        if (castExp != nullptr && (dynamic_cast<SgValueExp*>(castExp->get_operand()) ||
+                                   dynamic_cast<SgVarRefExp*>(castExp->get_operand()))) {
+          return false;
+        }
+
+        // report an expression only once
+        std::ostringstream oss;
+        JsonPrinter printer;
+        printer.printExpression(oss, node);
+        if (printed.insert(oss.str()).second) {
+          exprs.push_back(node);
+        }
+        return false;
+      }
+
+      // only operators are searched for invariant operands
+      return dynamic_cast<SgBinaryOp*>(node) != nullptr ||
+             dynamic_cast<SgUnaryOp*>(node) != nullptr;
+    });
+  }
+
+  void InvariantAnalysis::analyzeLoop(Loop* loop) {
+    std::set<Loop*> visited;
+    collectModified(loop, visited);
+
+    // variables read by constraints and updates of this loop
+    std::set<std::string> referenced;
+    std::vector<SgExpression*> exprs;
+    std::set<std::string> printed;
+    for (LoopPath* path : *loop) {
+      ConstraintList* cl = path->getConstraintList();
+      for (SgExpression* constraint : *cl) {
+        ASTHelper::collectVarNames(constraint, referenced);
+        collectInvariantExprs(constraint, exprs, printed);
+      }
+
+      VariableTable* varTbl = path->getVariableTable();
+      for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+        SgExpression* value = it->second->getValue();
+        ASTHelper::collectVarNames(value, referenced);
+        collectInvariantExprs(value, exprs, printed);
+      }
+    }
+
+    std::set<std::string> vars;
+    for (const std::string& name : referenced) {
+      if (modified.find(name) == modified.end()) {
+        vars.insert(name);
+      }
+    }
+
+    loop->setInvariantVars(vars);
+    loop->setInvariantExprs(exprs);
+  }
+
+  void InvariantAnalysis::analyze(Loop* loop) {
+    InvariantAnalysis analysis;
+    analysis.analyzeLoop(loop);
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      analyze(inner);
+    }
+  }
+
+}
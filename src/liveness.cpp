@@ -0,0 +1,228 @@
+#include "liveness.h"
+#include "astHelper.h"
+#include <cctype>
+#include <vector>
+
+namespace LE {
+
+  // collect identifiers in an operand name
+  // e.g. 'arr[(i + 1)]' -> 'arr', 'i'
+  static void collectNamesInOperand(const std::string& operand,
+                                    std::set<std::string>& names) {
+    std::string::size_type i = 0, len = operand.length();
+    while (i < len) {
+      if (isalpha(operand[i]) || operand[i] == '_') {
+        std::string::size_type begin = i;
+        while (i < len && (isalnum(operand[i]) || operand[i] == '_')) ++i;
+        names.insert(operand.substr(begin, i - begin));
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  void LivenessAnalysis::collectLocals(Loop* loop) {
+    VariableTable* varTbl = loop->getVariableTable();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      locals.insert(it->first);
+    }
+    for (Loop* inner : loop->getInnerLoops()) {
+      collectLocals(inner);
+    }
+  }
+
+  bool LivenessAnalysis::isNeeded(const std::string& name,
+                                  const std::set<std::string>& live) {
+    return !ASTHelper::isPlainName(name) ||
+           locals.find(name) == locals.end() ||
+           live.find(name) != live.end();
+  }
+
+  void LivenessAnalysis::addReads(const std::string& name, Variable* var,
+                                  std::set<std::string>& live) {
+    ASTHelper::collectVarNames(var->getValue(), live);
+    if (!ASTHelper::isPlainName(name)) {
+      collectNamesInOperand(name, live);
+    }
+  }
+
+  void LivenessAnalysis::handleBlock(Block* block, std::set<std::string>& live) {
+    VariableTable* varTbl = block->getVariableTable();
+
+    // an update read by another live update of the same block is kept too,
+    // since values in a block may refer to earlier updates of the block
+    std::set<std::string> needed;
+    std::set<std::string> reads;
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+        const std::string& name = it->first;
+        if (needed.count(name)) continue;
+        if (isNeeded(name, live) || reads.count(name)) {
+          needed.insert(name);
+          addReads(name, it->second, reads);
+          changed = true;
+        }
+      }
+    }
+
+    std::set<std::string>& used = liveUpdates[block];
+    used.insert(needed.begin(), needed.end());
+
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      live.erase(it->first);
+    }
+    live.insert(reads.begin(), reads.end());
+  }
+
+  std::set<std::string> LivenessAnalysis::computeLoopLive(Loop* loop,
+                                                          const std::set<std::string>& liveOut) {
+    std::set<std::string> live(liveOut);
+    size_t size;
+    do {
+      size = live.size();
+      // initial values of declarations are read in every iteration
+      VariableTable* decls = loop->getVariableTable();
+      for (auto it = decls->begin(), ie = decls->end(); it != ie; ++it) {
+        ASTHelper::collectVarNames(it->second->getInitValue(), live);
+      }
+
+      for (LoopPath* path : *loop) {
+        ConstraintList* cl = path->getConstraintList();
+        for (SgExpression* constraint : *cl) {
+          ASTHelper::collectVarNames(constraint, live);
+        }
+
+        VariableTable* varTbl = path->getVariableTable();
+        for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+          if (isNeeded(it->first, live)) {
+            addReads(it->first, it->second, live);
+          }
+        }
+      }
+
+      for (Loop* inner : loop->getInnerLoops()) {
+        std::set<std::string>&& innerLive = computeLoopLive(inner, live);
+        live.insert(innerLive.begin(), innerLive.end());
+      }
+    } while (live.size() != size);
+
+    return live;
+  }
+
+  std::set<std::string> LivenessAnalysis::handlePath(Path* path,
+                                                     const std::set<std::string>& liveOut) {
+    std::set<std::string> live(liveOut);
+    ASTHelper::collectVarNames(path->getReturnValue(), live);
+
+    // a constraint is checked somewhere in the path
+    // so its variables are treated as live everywhere
+    std::set<std::string> constraintVars;
+    ConstraintList* cl = path->getConstraints();
+    for (SgExpression* constraint : *cl) {
+      ASTHelper::collectVarNames(constraint, constraintVars);
+    }
+    // positions of declarations are not known, treat them like constraints
+    constraintVars.insert(initReads.begin(), initReads.end());
+    live.insert(constraintVars.begin(), constraintVars.end());
+
+    const std::vector<std::string>& elements = path->getPaths();
+    for (auto it = elements.rbegin(), ie = elements.rend(); it != ie; ++it) {
+      auto blockIter = blocks.find(*it);
+      if (blockIter != blocks.end()) {
+        handleBlock(blockIter->second, live);
+      } else {
+        auto loopIter = loops.find(*it);
+        if (loopIter == loops.end()) continue;
+
+        Loop* loop = loopIter->second;
+        loopLiveOut[loop].insert(live.begin(), live.end());
+        // a loop may run zero times, so nothing is killed
+        std::set<std::string>&& loopLive = computeLoopLive(loop, live);
+        live.insert(loopLive.begin(), loopLive.end());
+      }
+      live.insert(constraintVars.begin(), constraintVars.end());
+    }
+    return live;
+  }
+
+  void LivenessAnalysis::pruneLoop(Loop* loop, const std::set<std::string>& liveOut) {
+    std::set<std::string>&& live = computeLoopLive(loop, liveOut);
+
+    for (LoopPath* path : *loop) {
+      VariableTable* varTbl = path->getVariableTable();
+      std::vector<std::string> dead;
+      for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+        if (!isNeeded(it->first, live)) {
+          dead.push_back(it->first);
+        }
+      }
+      for (const std::string& name : dead) {
+        varTbl->removeVariable(name);
+      }
+    }
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      pruneLoop(inner, live);
+    }
+  }
+
+  void LivenessAnalysis::run(Function* func) {
+    VariableTable* varTbl = func->getVariableTable();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      locals.insert(it->first);
+      ASTHelper::collectVarNames(it->second->getInitValue(), initReads);
+    }
+
+    std::vector<Function*>&& scopes = func->getScopes();
+
+    for (Function* scope : scopes) {
+      for (Block* block : scope->getBlocks()) {
+        blocks[block->getName()] = block;
+      }
+      for (Loop* loop : scope->getLoops()) {
+        loops[loop->getName()] = loop;
+        collectLocals(loop);
+      }
+    }
+
+    // regions run one after another, so variables live at the entry
+    // of a region are live at the exit of the region before
+    std::set<std::string> liveOut;
+    for (auto it = scopes.rbegin(), ie = scopes.rend(); it != ie; ++it) {
+      std::set<std::string> liveIn;
+      for (Path* path : (*it)->getPaths()) {
+        std::set<std::string>&& live =
+          handlePath(path, path->isPathReturn() ? std::set<std::string>() : liveOut);
+        liveIn.insert(live.begin(), live.end());
+      }
+      liveOut.swap(liveIn);
+    }
+
+    for (auto& entry : blocks) {
+      Block* block = entry.second;
+      const std::set<std::string>& used = liveUpdates[block];
+      VariableTable* blockTbl = block->getVariableTable();
+      std::vector<std::string> dead;
+      for (auto it = blockTbl->begin(), ie = blockTbl->end(); it != ie; ++it) {
+        if (used.find(it->first) == used.end()) {
+          dead.push_back(it->first);
+        }
+      }
+      for (const std::string& name : dead) {
+        blockTbl->removeVariable(name);
+      }
+    }
+
+    for (auto& entry : loops) {
+      pruneLoop(entry.second, loopLiveOut[entry.second]);
+    }
+  }
+
+  void LivenessAnalysis::eliminateDeadUpdates(Function* func) {
+    LivenessAnalysis analysis;
+    analysis.run(func);
+  }
+
+}
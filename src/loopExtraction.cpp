@@ -1,9 +1,27 @@
 #include "loopExtraction.h"
 #include "printer.h"
+#include "smtPrinter.h"
+#include "sqlitePrinter.h"
+#include "treePrinter.h"
 #include "astHelper.h"
 #include "message.h"
+#include "diagnostics.h"
+#include "callSummary.h"
 #include "constraint.h"
 #include "nameAllocator.h"
+#include "workerPool.h"
+#include "astCache.h"
+#include "invariant.h"
+#include "liveness.h"
+#include "blockCoalescing.h"
+#include "pathDeduplication.h"
+#include "dependence.h"
+#include "ompAnnotation.h"
+#include "trace.h"
+#include "fingerprint.h"
+#include "access.h"
+#include "witness.h"
+#include "range.h"
 
 #include <iostream>
 #include <cassert>
@@ -11,9 +29,64 @@
 #include <sstream>
 #include <set>
 #include <map>
+#include <algorithm>
 
 namespace LE {
 
+  // number of names of each kind a task may allocate
+  // each task allocates names from its own range, whichever process
+  // runs it, so that names stay global unique across processes
+  static const long taskNameRange = 1L << 24;
+
+  // location of a node in trace events, only computed when tracing
+  static std::string traceLocation(SgNode* node) {
+    return Trace::isEnabled() ? ASTHelper::getLocation(node) : "";
+  }
+
+  // end the trace span of a loop, whose body is handled after its handler
+  // returns, see LoopExtraction::schedule
+  static void traceLoop(const char* kind, SgStatement* stmt, long begin) {
+    if (Trace::isEnabled()) {
+      Trace::span("loop", kind, begin, Trace::now(), "location", ASTHelper::getLocation(stmt));
+    }
+  }
+
+  // whether a command line argument names a C/C++ source file
+  static bool isSourceFile(const std::string& arg) {
+    static const std::set<std::string> suffixes = {
+      "c", "cc", "cp", "cpp", "cxx", "c++", "C", "CC", "CPP"
+    };
+
+    if (arg.empty() || arg[0] == '-') return false;
+    std::string::size_type dot = arg.rfind('.');
+    if (dot == std::string::npos) return false;
+    return suffixes.count(arg.substr(dot + 1)) > 0;
+  }
+
+  // whether a command line flag takes its value as the next argument
+  static bool takesArgument(const std::string& arg) {
+    static const std::set<std::string> flags = {
+      "-o", "-I", "-D", "-U", "-x", "-include", "-imacros", "-isystem",
+      "-iquote", "-idirafter", "-MF", "-MT", "-MQ", "-L", "-l"
+    };
+    return flags.count(arg) > 0;
+  }
+
+  Printer* LoopExtraction::createPrinter(VariableTable* globals) {
+    Printer* printer;
+    if (options.format == "smt2") {
+      printer = new SmtPrinter(globals);
+    } else if (options.format == "sqlite") {
+      printer = new SqlitePrinter(options.db);
+    } else if (options.layout == "tree") {
+      printer = new TreePrinter;
+    } else {
+      printer = new JsonPrinter;
+    }
+    printer->setSections(options.sections);
+    return printer;
+  }
+
   std::string LoopExtraction::getOperandName(SgExpression* expr) {
     std::ostringstream oss;
     JsonPrinter printer;
@@ -21,6 +94,23 @@ namespace LE {
     return oss.str();
   }
 
+  SgExpression* LoopExtraction::currentValues(SgExpression* expr, VariableTable* varTbl) {
+    std::map<std::string, SgExpression*> values;
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      if (ASTHelper::isPlainName(it->first)) {
+        values[it->first] = it->second->getValue();
+      }
+    }
+    return ASTHelper::substitute(expr, values);
+  }
+
+  SgExpression* LoopExtraction::getTarget(SgExpression* operand, VariableTable* varTbl) {
+    if (ASTHelper::isPlainName(getOperandName(operand))) return nullptr;
+
+    // subscripts read values of variables before this update
+    return currentValues(operand, varTbl);
+  }
+
   Loop* LoopExtraction::saveLoopInFunction(Function* func) {
     std::string&& loopName = LoopNameAllocator::allocName();
     Loop* loop = new Loop(loopName, new VariableTable);
@@ -43,52 +133,91 @@ namespace LE {
             dynamic_cast<SgSwitchStatement*>(stmt);
   }
 
+  void LoopExtraction::schedule(const std::vector<Task>& tasks) {
+    for (auto it = tasks.rbegin(), ie = tasks.rend(); it != ie; ++it) {
+      pending.push_back(*it);
+    }
+  }
+
+  void LoopExtraction::runPending(size_t base) {
+    while (pending.size() > base) {
+      Task task = std::move(pending.back());
+      pending.pop_back();
+      task();
+    }
+  }
+
   void LoopExtraction::handleExpression(SgExpression* expr, VariableTable* varTbl) {
     // depth-first-search, handle all sub-expression first
-    if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
-      SgExpression* leftExpr = binOp->get_lhs_operand();
-      handleExpression(leftExpr, varTbl);
-
-      SgExpression* rightExpr = binOp->get_rhs_operand();
-      handleExpression(rightExpr, varTbl);
-    } else if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(expr)) {
-      SgExpression* operand = unaryOp->get_operand();
-      handleExpression(operand, varTbl);
+    // an expression is expanded into its operands when it's first on top,
+    // and handled when it's on top again after them
+    std::vector<std::pair<SgExpression*, bool> > stack;
+    stack.push_back(std::make_pair(expr, false));
+    while (!stack.empty()) {
+      SgExpression* top = stack.back().first;
+      if (stack.back().second) {
+        stack.pop_back();
+        handleUpdate(top, varTbl);
+        continue;
+      }
+      stack.back().second = true;
+
+      // operands are pushed in reverse, so they are handled from left to right
+      if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(top)) {
+        stack.push_back(std::make_pair(binOp->get_rhs_operand(), false));
+        stack.push_back(std::make_pair(binOp->get_lhs_operand(), false));
+      } else if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(top)) {
+        stack.push_back(std::make_pair(unaryOp->get_operand(), false));
+      } else if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(top)) {
+        std::vector<SgExpression*>& args = call->get_args()->get_expressions();
+        for (auto it = args.rbegin(), ie = args.rend(); it != ie; ++it) {
+          stack.push_back(std::make_pair(*it, false));
+        }
+      }
     }
+  }
 
+  void LoopExtraction::handleUpdate(SgExpression* expr, VariableTable* varTbl) {
     // handle all expressions that changes values of variables
     SgUnaryOp *unaryOp;
     if (SgAssignOp *assignOp = dynamic_cast<SgAssignOp*>(expr)) {
       // assignment
       SgExpression* leftExpr = assignOp->get_lhs_operand();
       std::string&& name = getOperandName(leftExpr);
-      SgExpression* value = ASTHelper::clone(assignOp->get_rhs_operand());
+      SgExpression* target = getTarget(leftExpr, varTbl);
+      SgExpression* value = calls.inlineCalls(assignOp->get_rhs_operand());
 
       Variable* oldVar = varTbl->getVariable(name);
       if (oldVar != nullptr) {
         ASTHelper::replaceVar(value, oldVar->getValue(), name);
       }
+      SgExpression* old = oldVar != nullptr ? oldVar->getValue() : leftExpr;
+      value = guardValue(value, ASTHelper::clone(old), varTbl);
 
-      Variable* newVar = new Variable(name, value);
+      Variable* newVar = new Variable(name, value, target);
       varTbl->addVariable(newVar);
     } else if ((unaryOp = dynamic_cast<SgPlusPlusOp*>(expr))
             || (unaryOp = dynamic_cast<SgMinusMinusOp*>(expr))) {
       // ++/--
       SgExpression* opExpr = unaryOp->get_operand();
       std::string&& name = getOperandName(opExpr);
+      SgExpression* target = getTarget(opExpr, varTbl);
       SgExpression* value = ASTHelper::clone(unaryOp);
 
       Variable* oldVar = varTbl->getVariable(name);
       if (oldVar != nullptr) {
         ASTHelper::replaceVar(value, oldVar->getValue(), name);
       }
+      SgExpression* old = oldVar != nullptr ? oldVar->getValue() : opExpr;
+      value = guardValue(value, ASTHelper::clone(old), varTbl);
 
-      Variable* newVar = new Variable(name, value);
+      Variable* newVar = new Variable(name, value, target);
       varTbl->addVariable(newVar);
     } else if (SgCompoundAssignOp *compoundOp = dynamic_cast<SgCompoundAssignOp*>(expr)) {
       // +=, -=, *= ...
       SgExpression* leftExpr = compoundOp->get_lhs_operand();
       std::string name = getOperandName(leftExpr);
+      SgExpression* target = getTarget(leftExpr, varTbl);
 
       Variable* oldVar = varTbl->getVariable(name);
       SgExpression *lhsValue, *rhsValue;
@@ -96,18 +225,189 @@ namespace LE {
         SgCompoundAssignOp* newValue = ASTHelper::clone(compoundOp);
         ASTHelper::replaceVar(newValue, oldVar->getValue(), name);
         lhsValue = newValue->get_lhs_operand();
-        rhsValue = newValue->get_rhs_operand();
+        rhsValue = calls.inlineCalls(newValue->get_rhs_operand());
       } else {
         lhsValue = ASTHelper::clone(leftExpr);
-        rhsValue = ASTHelper::clone(compoundOp->get_rhs_operand());
+        rhsValue = calls.inlineCalls(compoundOp->get_rhs_operand());
       }
 
       SgBinaryOp* binOp = ASTHelper::toBinaryOp(
         compoundOp->variantT(), lhsValue, rhsValue, compoundOp->get_type()
       );
+      SgExpression* old = oldVar != nullptr ? oldVar->getValue() : leftExpr;
+      SgExpression* value = guardValue(binOp, ASTHelper::clone(old), varTbl);
+
+      varTbl->addVariable(new Variable(name, value, target));
+    } else if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(expr)) {
+      // non-local variables updated by callee, see CallSummaries
+      for (auto& update : calls.getUpdates(call)) {
+        SgExpression* value = update.second;
+        Variable* oldVar = varTbl->getVariable(update.first);
+        if (oldVar != nullptr) {
+          ASTHelper::replaceVar(value, oldVar->getValue(), update.first);
+        }
+        SgExpression* old = oldVar != nullptr ? oldVar->getValue()
+                                              : calls.getSummary(call)->targets[update.first];
+        value = guardValue(value, ASTHelper::clone(old), varTbl);
+        varTbl->addVariable(new Variable(update.first, value));
+      }
+    }
+  }
+
+  SgExpression* LoopExtraction::guardValue(SgExpression* value, SgExpression* old,
+                                           VariableTable* varTbl) {
+    if ((guards.empty() && returned == nullptr) || value == nullptr || old == nullptr) {
+      return value;
+    }
 
-      varTbl->addVariable(new Variable(name, binOp));
+    // the guard reads values before this update, as the value does
+    SgExpression* guard = nullptr;
+    if (returned != nullptr) {
+      guard = new SgNotOp(currentValues(returned, varTbl), returned->get_type());
+    }
+    if (!guards.empty()) {
+      SgExpression* inner = currentValues(guards.back(), varTbl);
+      guard = guard == nullptr ? inner : new SgAndOp(guard, inner, SgTypeBool::createType());
     }
+    return new SgConditionalExp(guard, value, old, value->get_type());
+  }
+
+  void LoopExtraction::suspendGuards() {
+    suspended.push_back(GuardState{guards, branchReturns, returned});
+    guards.clear();
+    branchReturns.clear();
+    returned = nullptr;
+  }
+
+  void LoopExtraction::resumeGuards() {
+    GuardState& state = suspended.back();
+    guards.swap(state.guards);
+    branchReturns.swap(state.branchReturns);
+    returned = state.returned;
+    suspended.pop_back();
+  }
+
+  void LoopExtraction::closeReturn(Path* path, SgExpression* value) {
+    auto open = openReturns.find(path);
+    if (open == openReturns.end()) return;
+    open->second->set_false_exp(value);
+    openReturns.erase(open);
+    path->setPathReturn(true);
+  }
+
+  void LoopExtraction::joinBranchReturns() {
+    std::set<Path*> falseReturns = branchReturns.back();
+    branchReturns.pop_back();
+    std::set<Path*> trueReturns = branchReturns.back();
+    branchReturns.pop_back();
+    guards.pop_back();
+
+    for (Path* p : trueReturns) {
+      if (falseReturns.count(p) == 0) continue;
+      if (!branchReturns.empty()) {
+        branchReturns.back().insert(p);
+        continue;
+      }
+
+      // the last open return is only reached if its guard holds
+      auto open = openReturns.find(p);
+      if (open != openReturns.end()) {
+        closeReturn(p, ASTHelper::clone(open->second->get_true_exp()));
+      }
+    }
+  }
+
+  void LoopExtraction::returnFromPaths(Function* func, const std::string& blockName,
+                                       SgExpression* retVal) {
+    for (Path* p : func->getPaths()) {
+      if (p->isPathReturn()) continue;
+      p->addPath(blockName);
+
+      // a return in a branch chooses the value by its guard,
+      // the path goes on to the next return
+      SgExpression* value = retVal;
+      SgConditionalExp* open = nullptr;
+      if (!guards.empty() && retVal != nullptr) {
+        open = new SgConditionalExp(ASTHelper::clone(guards.back()), retVal,
+                                    nullptr, retVal->get_type());
+        value = open;
+      }
+
+      auto prev = openReturns.find(p);
+      if (prev != openReturns.end()) {
+        if (value != nullptr) {
+          prev->second->set_false_exp(value);
+        }
+        openReturns.erase(prev);
+      } else {
+        p->setReturnValue(value);
+      }
+
+      if (open != nullptr) {
+        openReturns[p] = open;
+      } else if (guards.empty()) {
+        p->setPathReturn(true);
+      }
+      if (!guards.empty()) {
+        branchReturns.back().insert(p);
+      }
+    }
+
+    // updates after a return in a branch are not made under its guard
+    if (!guards.empty()) {
+      SgExpression* guard = ASTHelper::clone(guards.back());
+      returned = returned == nullptr ? guard : new SgOrOp(returned, guard, SgTypeBool::createType());
+    }
+  }
+
+  void LoopExtraction::breakLoopPaths(Loop* loop) {
+    if (guards.empty()) {
+      for (auto it = loop->begin(), ie = loop->end(); it != ie; ++it) {
+        (*it)->setCanBreak(true);
+      }
+      return;
+    }
+
+    // paths that break under the guard, and go on otherwise
+    SgExpression* guard = guards.back();
+    Loop* broken = loop->cloneWithoutBreak();
+    for (LoopPath* loopPath : *broken) {
+      loopPath->addConstraint(currentValues(guard, loopPath->getVariableTable()));
+      loopPath->setCanBreak(true);
+    }
+    for (LoopPath* loopPath : *loop) {
+      if (!loopPath->canBreakLoop()) {
+        loopPath->addConstraint(new SgNotOp(currentValues(guard, loopPath->getVariableTable()),
+                                            guard->get_type()));
+      }
+    }
+    loop->merge(broken);
+  }
+
+  void LoopExtraction::handleGuardedBranches(SgExpression* condition, const Task& trueBranch,
+                                             const Task& falseBranch) {
+    // a branch in a branch is guarded by both conditions
+    SgExpression* trueGuard = ASTHelper::clone(condition);
+    SgExpression* falseGuard = new SgNotOp(ASTHelper::clone(condition), condition->get_type());
+    if (!guards.empty()) {
+      SgExpression* outer = guards.back();
+      trueGuard = new SgAndOp(ASTHelper::clone(outer), trueGuard, SgTypeBool::createType());
+      falseGuard = new SgAndOp(ASTHelper::clone(outer), falseGuard, SgTypeBool::createType());
+    }
+
+    schedule({
+      [=] {
+        guards.push_back(trueGuard);
+        branchReturns.push_back(std::set<Path*>());
+      },
+      trueBranch,
+      [=] {
+        guards.back() = falseGuard;
+        branchReturns.push_back(std::set<Path*>());
+      },
+      falseBranch,
+      [=] { joinBranchReturns(); }
+    });
   }
 
   void LoopExtraction::handleExprInLoop(SgExpression* expr, Loop* loop) {
@@ -147,9 +447,7 @@ namespace LE {
   }
 
   void LoopExtraction::handleBreakInLoop(SgBreakStmt* breakStmt, Loop* loop) {
-    for (auto it = loop->begin(), ie = loop->end(); it != ie; ++it) {
-      (*it)->setCanBreak(true);
-    }
+    breakLoopPaths(loop);
   }
 
   void LoopExtraction::handleReturnInLoop(SgReturnStmt* returnStmt, Loop* loop) {
@@ -159,15 +457,13 @@ namespace LE {
 
     // if we encounter a return statement
     // that means all loop path can break the loop
-    for (auto it = loop->begin(), ie = loop->end(); it != ie; ++it) {
-      (*it)->setCanBreak(true);
-    }
+    breakLoopPaths(loop);
   }
 
   void LoopExtraction::handleSwitchStatement(SgSwitchStatement* switchStmt,
                                              Loop* loop) {
     // TODO
-    Message::warning("switch-case unsupported yet");
+    Message::warning("switch-case unsupported yet", ASTHelper::getLocation(switchStmt));
   }
 
   void LoopExtraction::handeIfInLoop(SgIfStmt* ifStmt, Loop* loop) {
@@ -177,32 +473,39 @@ namespace LE {
     assert(exprStmt != nullptr);
     SgExpression* condition = exprStmt->get_expression();
     handleExprInLoop(condition, loop);
+    condition = calls.inlineCalls(condition);
+
+    SgStatement* trueBody = ifStmt->get_true_body();
+    SgStatement* falseBody = ifStmt->get_false_body();
+    if (options.fast) {
+      handleGuardedBranches(condition, [=] { handleStmtInLoop(trueBody, loop); },
+                            [=] { if (falseBody != nullptr) handleStmtInLoop(falseBody, loop); });
+      return;
+    }
 
     // fork origin paths and add contradictory constraint
+    // a constraint reads the values the path has so far, in terms of
+    // values at the start of the iteration, like its updates
     Loop* newLoop = loop->cloneWithoutBreak();
     for (auto it = newLoop->begin(), ie = newLoop->end(); it != ie; ++it) {
-      (*it)->addConstraint(new SgNotOp(condition, condition->get_type()));
+      SgExpression* current = currentValues(condition, (*it)->getVariableTable());
+      (*it)->addConstraint(new SgNotOp(current, condition->get_type()));
     }
 
     // add constraint to origin loop
     for (auto it = loop->begin(), ie = loop->end(); it != ie; ++it) {
       if (!(*it)->canBreakLoop()) {
-        (*it)->addConstraint(condition);
+        (*it)->addConstraint(currentValues(condition, (*it)->getVariableTable()));
       }
     }
 
-    // handle true body
-    SgStatement* trueBody = ifStmt->get_true_body();
-    handleStmtInLoop(trueBody, loop);
-
-    // handle false body
-    SgStatement* falseBody = ifStmt->get_false_body();
-    if (falseBody != nullptr) {
-      handleStmtInLoop(falseBody, newLoop);
-    }
-
-    // merge information of false body into true body
-    loop->merge(newLoop);
+    // handle true body and false body,
+    // then merge information of false body into true body
+    schedule({
+      [=] { handleStmtInLoop(trueBody, loop); },
+      [=] { if (falseBody != nullptr) handleStmtInLoop(falseBody, newLoop); },
+      [=] { loop->merge(newLoop); }
+    });
   }
 
   void LoopExtraction::handleIfInFunction(SgIfStmt* ifStmt, Function* func) {
@@ -211,6 +514,15 @@ namespace LE {
     SgExprStatement* exprStmt = dynamic_cast<SgExprStatement*>(conditionStmt);
     SgExpression* condition = exprStmt->get_expression();
     handleExpression(condition, func->getVariableTable());
+    condition = calls.inlineCalls(condition);
+
+    SgStatement* trueBody = ifStmt->get_true_body();
+    SgStatement* falseBody = ifStmt->get_false_body();
+    if (options.fast) {
+      handleGuardedBranches(condition, [=] { handleStmtInFunction(trueBody, func); },
+                            [=] { if (falseBody != nullptr) handleStmtInFunction(falseBody, func); });
+      return;
+    }
 
     // fork origin paths and add contradictory constraint
     Function* newFunc = func->cloneNotReturnPaths();
@@ -227,27 +539,26 @@ namespace LE {
       }
     }
 
-    // handle true body
-    SgStatement* trueBody = ifStmt->get_true_body();
-    handleStmtInFunction(trueBody, func);
-
-    // handle false body
-    SgStatement* falseBody = ifStmt->get_false_body();
-    if (falseBody != nullptr) {
-      handleStmtInFunction(falseBody, newFunc);
-    }
-
-    // merge information of false body into true body
-    func->merge(newFunc);
+    // handle true body and false body,
+    // then merge information of false body into true body
+    schedule({
+      [=] { handleStmtInFunction(trueBody, func); },
+      [=] { if (falseBody != nullptr) handleStmtInFunction(falseBody, newFunc); },
+      [=] { func->merge(newFunc); }
+    });
   }
 
   void LoopExtraction::handleWhileStatment(SgWhileStmt* whileStmt, Loop* loop) {
+    long begin = Trace::now();
+    loop->setStatement(whileStmt);
+    suspendGuards();
     // handle condition of while
     SgStatement* testStmt = whileStmt->get_condition();
     SgExprStatement* exprStmt = dynamic_cast<SgExprStatement*>(testStmt);
     assert(exprStmt != nullptr);
     SgExpression* condition = exprStmt->get_expression();
     handleExprInLoop(condition, loop);
+    condition = calls.inlineCalls(condition);
 
     VariableTable *varTbl = new VariableTable;
 
@@ -267,14 +578,28 @@ namespace LE {
 
     // handle body of while
     SgStatement* bodyStmt = whileStmt->get_body();
-    handleStmtInLoop(bodyStmt, loop);
+    schedule({
+      [=] { handleStmtInLoop(bodyStmt, loop); },
+      [=] {
+        resumeGuards();
+        traceLoop("while", whileStmt, begin);
+      }
+    });
   }
 
   void LoopExtraction::handleForStatement(SgForStatement* forStmt, Loop* loop) {
+    long begin = Trace::now();
+    loop->setStatement(forStmt);
+    suspendGuards();
     SgForInitStatement* initBlock= forStmt->get_for_init_stmt();
     SgStatementPtrList& initStmts = initBlock->get_init_stmt();
-    handleBlockInLoop(initStmts, loop);
+    schedule({
+      [=, &initStmts] { handleBlockInLoop(initStmts, loop); },
+      [=] { handleForLoopPaths(forStmt, loop, begin); }
+    });
+  }
 
+  void LoopExtraction::handleForLoopPaths(SgForStatement* forStmt, Loop* loop, long begin) {
     SgStatement* testStmt = forStmt->get_test();
     SgExprStatement* exprStmt = dynamic_cast<SgExprStatement*>(testStmt);
     SgExpression* condition = nullptr;
@@ -285,6 +610,7 @@ namespace LE {
     // collect variables involved in for_test_statement
     // and store them in VariableTable
     handleExprInLoop(condition, loop);
+    condition = calls.inlineCalls(condition);
 
     VariableTable *varTbl = new VariableTable;
 
@@ -310,16 +636,23 @@ namespace LE {
     loop->addPath(inPath);
     loop->addPath(outPath);
 
-    // handle loop body
+    // handle loop body, then increment
     SgStatement* bodyStmt = forStmt->get_loop_body();
-    handleStmtInLoop(bodyStmt, loop);
-
-    // handle increment
     SgExpression* incExpr = forStmt->get_increment();
-    handleExprInLoop(incExpr, loop);
+    schedule({
+      [=] { handleStmtInLoop(bodyStmt, loop); },
+      [=] {
+        handleExprInLoop(incExpr, loop);
+        resumeGuards();
+        traceLoop("for", forStmt, begin);
+      }
+    });
   }
 
   void LoopExtraction::handleDoWhileStatement(SgDoWhileStmt* doStmt, Loop* loop) {
+    long begin = Trace::now();
+    loop->setStatement(doStmt);
+    suspendGuards();
     // create a loop path
     // in do-while, body must at least be executed once
     // so at the beginning, the loop has a path
@@ -328,23 +661,33 @@ namespace LE {
     LoopPath* path = new LoopPath(varTbl, cl, false);
     loop->addPath(path);
 
-    // handle body of do-while
+    // handle body of do-while, then its condition
     SgStatement* bodyStmt = doStmt->get_body();
-    handleStmtInLoop(bodyStmt, loop);
+    schedule({
+      [=] { handleStmtInLoop(bodyStmt, loop); },
+      [=] {
+        handleDoWhileCondition(doStmt, loop);
+        resumeGuards();
+        traceLoop("do-while", doStmt, begin);
+      }
+    });
+  }
 
+  void LoopExtraction::handleDoWhileCondition(SgDoWhileStmt* doStmt, Loop* loop) {
     // handle condition of do-while
     SgStatement* testStmt = doStmt->get_condition();
     SgExprStatement* exprStmt = dynamic_cast<SgExprStatement*>(testStmt);
     assert(exprStmt != nullptr);
     SgExpression* condition = exprStmt->get_expression();
+    SgExpression* constraint = calls.inlineCalls(condition);
 
     // fork a new set of paths
     // mark these paths canBreak = true
     Loop* newLoop = loop->cloneWithoutBreak();
     handleExprInLoop(condition, newLoop);
-    SgExpression* outCond = new SgNotOp(condition, condition->get_type());
     for (LoopPath* loopPath : *newLoop) {
-      loopPath->addConstraint(outCond);
+      SgExpression* current = currentValues(constraint, loopPath->getVariableTable());
+      loopPath->addConstraint(new SgNotOp(current, constraint->get_type()));
       loopPath->setCanBreak(true);
     }
 
@@ -352,7 +695,7 @@ namespace LE {
     handleExprInLoop(condition, loop);
     for (LoopPath* loopPath : *loop) {
       if (!loopPath->canBreakLoop()) {
-        loopPath->addConstraint(condition);
+        loopPath->addConstraint(currentValues(constraint, loopPath->getVariableTable()));
       }
     }
 
@@ -391,7 +734,7 @@ namespace LE {
     } else {
       std::stringstream ss;
       ss << stmt->class_name() << " unsupported in loop block\n";
-      Message::warning(ss.str());
+      Message::warning(ss.str(), ASTHelper::getLocation(stmt));
     }
   }
 
@@ -430,35 +773,38 @@ namespace LE {
 
       SgExpression* expr = returnStmt->get_expression();
       handleExpression(expr, block->getVariableTable());
-      SgExpression* retVal = ASTHelper::clone(expr);
+      SgExpression* retVal = calls.inlineCalls(expr);
 
       func->addBlock(block);
-      for (Path* p : func->getPaths()) {
-        if (!p->isPathReturn()) {
-          p->addPath(name);
-          p->setPathReturn(true);
-          p->setReturnValue(retVal);
-        }
-      }
+      returnFromPaths(func, name, retVal);
     } else {
       std::stringstream ss;
       ss << stmt->class_name() << " unsupported in LoopExtraction::handleStmtInFunction\n";
-      Message::warning(ss.str());
+      Message::warning(ss.str(), ASTHelper::getLocation(stmt));
     }
   }
 
   void LoopExtraction::handleBlockInLoop(SgStatementPtrList& stmts, Loop* loop) {
+    std::vector<Task> tasks;
     for (SgStatement* stmt : stmts) {
-      handleStmtInLoop(stmt, loop);
+      tasks.push_back([=] { handleStmtInLoop(stmt, loop); });
     }
+    schedule(tasks);
   }
 
-  void LoopExtraction::handleBlockInFunction(SgStatementPtrList& stmts, Function* func) {
-    auto it = stmts.begin(), ie = stmts.end();
+  void LoopExtraction::handleBlockInFunction(SgStatementPtrList& stmts, Function* func,
+                                             size_t first) {
+    auto it = stmts.begin() + first, ie = stmts.end();
     while (it != ie) {
       if (isAtomStatement(*it)) {
-        handleStmtInFunction(*(it++), func);
-        continue;
+        // the rest of the block is handled after the atom statement
+        SgStatement* stmt = *it;
+        size_t next = it - stmts.begin() + 1;
+        schedule({
+          [=] { handleStmtInFunction(stmt, func); },
+          [=, &stmts] { handleBlockInFunction(stmts, func, next); }
+        });
+        return;
       }
 
       std::string&& name = BlockNameAllocator::allocName();
@@ -473,14 +819,8 @@ namespace LE {
           SgExpression* expr = returnStmt->get_expression();
           handleExpression(expr, block->getVariableTable());
 
-          SgExpression* rv = ASTHelper::clone(expr);
-          for (Path* p : func->getPaths()) {
-            if (!p->isPathReturn()) {
-              p->setReturnValue(rv);
-              p->setPathReturn(true);
-              p->addPath(name);
-            }
-          }
+          SgExpression* rv = calls.inlineCalls(expr);
+          returnFromPaths(func, name, rv);
 
           func->addBlock(block);
           return;
@@ -488,7 +828,7 @@ namespace LE {
         } else {
           std::stringstream ss;
           ss << (*it)->class_name() << " unsupported in LoopExtraction::handleBlockInFunction\n";
-          Message::warning(ss.str());
+          Message::warning(ss.str(), ASTHelper::getLocation(*it));
         }
         ++it;
       } while (it != ie && !isAtomStatement(*it));
@@ -502,31 +842,210 @@ namespace LE {
     }
   }
 
+  bool LoopExtraction::isHot(SgFunctionDeclaration* funcDecl) const {
+    return profile == nullptr || profile->getWeight(funcDecl) >= options.profileThreshold;
+  }
+
+  std::vector<size_t> LoopExtraction::splitRegions(SgStatementPtrList& stmts) {
+    std::vector<size_t> starts;
+    if (stmts.empty()) return starts;
+
+    // a jump may enter or leave a region in the middle
+    for (SgStatement* stmt : stmts) {
+      if (!NodeQuery::querySubTree(stmt, V_SgGotoStatement).empty() ||
+          !NodeQuery::querySubTree(stmt, V_SgLabelStatement).empty()) {
+        return starts;
+      }
+    }
+
+    starts.push_back(0);
+    for (size_t i = 0; i + 1 < stmts.size(); ++i) {
+      if (!NodeQuery::querySubTree(stmts[i], V_SgReturnStmt).empty()) break;
+      if (dynamic_cast<SgIfStmt*>(stmts[i]) != nullptr) {
+        starts.push_back(i + 1);
+      }
+    }
+    return starts;
+  }
+
   void LoopExtraction::handleSgFunction(SgFunctionDeclaration* funcDecl,
                                         Function* func) {
+    TraceScope scope("function", funcDecl->get_name().getString(),
+                     "location", traceLocation(funcDecl));
     func->setName(funcDecl->get_name().getString());
+    if (profile != nullptr) {
+      func->setProfileWeight(profile->getWeight(funcDecl));
+    }
 
+    // a local anywhere in the function shadows a non-local of a callee
+    // of the same name, see CallSummaries
+    std::set<std::string> locals;
     SgFunctionParameterList* params = funcDecl->get_parameterList();
     for (SgInitializedName* param : params->get_args()) {
       std::string name = param->get_name().getString();
       SgType* type = param->get_type();
       func->addParam(name);
       func->addVariable(new Variable(type->variantT(), name, nullptr));
+      locals.insert(name);
     }
 
     SgFunctionDefinition* funcDef = funcDecl->get_definition();
     SgBasicBlock* funcBody = funcDef->get_body();
+    for (SgNode* node : NodeQuery::querySubTree(funcBody, V_SgVariableDeclaration)) {
+      SgVariableDeclaration* varDecl = dynamic_cast<SgVariableDeclaration*>(node);
+      if (varDecl == nullptr) continue;
+      for (SgInitializedName* name : varDecl->get_variables()) {
+        locals.insert(name->get_name().getString());
+      }
+    }
+    calls.setCallerLocals(locals);
     SgStatementPtrList& stmtList = funcBody->get_statements();
 
-    std::string&& pathName = PathNameAllocator::allocName();
-    Path* initPath = new Path(pathName, new ConstraintList);
-    func->addPath(initPath);
+    std::vector<size_t> starts;
+    if (options.regions) {
+      starts = splitRegions(stmtList);
+    }
+
+    if (starts.size() > 1) {
+      // regions share variables of the function, but paths of one region
+      // don't fork those of the others
+      for (size_t k = 0; k < starts.size(); ++k) {
+        size_t end = k + 1 < starts.size() ? starts[k + 1] : stmtList.size();
+        SgStatementPtrList stmts(stmtList.begin() + starts[k], stmtList.begin() + end);
+
+        Function* region = new Function(func->getVariableTable());
+        region->setName("region" + std::to_string(k + 1));
+        region->addPath(new Path(PathNameAllocator::allocName(), new ConstraintList));
+        size_t base = pending.size();
+        handleBlockInFunction(stmts, region);
+        runPending(base);
+        func->addRegion(region);
+      }
+    } else {
+      std::string&& pathName = PathNameAllocator::allocName();
+      Path* initPath = new Path(pathName, new ConstraintList);
+      func->addPath(initPath);
+
+      size_t base = pending.size();
+      handleBlockInFunction(stmtList, func);
+      runPending(base);
+    }
+
+    // a path that returned in a branch and never after falls off the end,
+    // where its value is that of a path without return value, see Evaluator
+    std::vector<Path*> open;
+    for (auto& openReturn : openReturns) {
+      open.push_back(openReturn.first);
+    }
+    for (Path* p : open) {
+      closeReturn(p, new SgIntVal(0, "0"));
+    }
+    returned = nullptr;
+
+    // with -le:fast, only accesses are collected, as the passes below
+    // cost more than linear time
+    if (options.fast) {
+      AccessAnalysis::analyze(func);
+      return;
+    }
+
+    // cold functions skip the passes below
+    if (!isHot(funcDecl)) return;
+
+    TraceScope passes("function", "passes");
+
+    if (!options.keepDead) {
+      LivenessAnalysis::eliminateDeadUpdates(func);
+    }
+
+    for (Function* region : func->getScopes()) {
+      if (!options.noCoalesce) {
+        BlockCoalescing::coalesce(region);
+      }
+
+      if (!options.noDedup) {
+        PathDeduplication::deduplicate(region);
+      }
+
+      for (Loop* loop : region->getLoops()) {
+        InvariantAnalysis::analyze(loop);
+        DependenceAnalysis::analyze(loop);
+      }
+
+      if (options.omp) {
+        OmpAnnotation annotation(calls);
+        for (Loop* loop : region->getLoops()) {
+          annotation.annotate(loop);
+        }
+      }
+    }
+
+    // after deduplication, so that merged paths share their ranges
+    if (options.ranges) {
+      TraceScope ranges("function", "ranges");
+      RangeAnalysis::analyze(func);
+    }
+
+    // after deduplication, so that merged paths share a witness
+    if (options.witnesses > 0) {
+      TraceScope witnesses("function", "witnesses");
+      WitnessSampler::sample(func, options.witnesses);
+    }
+  }
 
-    handleBlockInFunction(stmtList, func);
+  std::vector<std::string> LoopExtraction::handleFunctionsInWorkers(
+    const std::vector<SgFunctionDeclaration*>& funcDecls, VariableTable* globals) {
+    int nTasks = funcDecls.size();
+    int workers = options.jobs;
+
+    WorkerPool pool(workers);
+    std::vector<std::string> functions = pool.run(nTasks,
+      [&](int i, std::ostream& os) {
+        // task i runs in worker i % workers, or in parent if the worker failed
+        // either way it allocates from range i + 1, as tasks of the same
+        // worker would collide in a range per worker
+        long range = (i + 1) * taskNameRange;
+        LoopNameAllocator::advance(range);
+        PathNameAllocator::advance(range);
+        BlockNameAllocator::advance(range);
+        long loops = LoopNameAllocator::next();
+        long paths = PathNameAllocator::next();
+        long blocks = BlockNameAllocator::next();
+
+        Function* func = new Function(new VariableTable);
+        handleSgFunction(funcDecls[i], func);
+
+        TraceScope print("print", func->getName());
+        Printer* printer = createPrinter(globals);
+        printer->printFunction(os, func, printer->getFunctionIndent());
+        delete printer;
+        delete func;
+
+        if (LoopNameAllocator::next() - loops > taskNameRange ||
+            PathNameAllocator::next() - paths > taskNameRange ||
+            BlockNameAllocator::next() - blocks > taskNameRange) {
+          Message::warning("too many names in function, names may collide with the next function",
+                           ASTHelper::getLocation(funcDecls[i]));
+        }
+
+        LoopNameAllocator::advance(-range);
+        PathNameAllocator::advance(-range);
+        BlockNameAllocator::advance(-range);
+      });
+
+    // skip names allocated by tasks
+    long used = (nTasks + 1) * taskNameRange;
+    LoopNameAllocator::advance(used);
+    PathNameAllocator::advance(used);
+    BlockNameAllocator::advance(used);
+
+    return functions;
   }
 
-  void LoopExtraction::handleSgGlobal(SgGlobal* global, Program* program) {
+  void LoopExtraction::handleSgGlobal(SgGlobal* global, Program* program,
+                                      std::vector<std::string>& functions) {
     std::vector<SgNode*> decls = global->get_traversalSuccessorContainer();
+    std::vector<SgFunctionDeclaration*> funcDecls;
 
     // the first four declarations are not user-deifined, so we skip it
     // this conclusion is attained from observation
@@ -534,15 +1053,91 @@ namespace LE {
     for (int i = 5; i < size; ++i) {
       SgNode *decl = decls[i];
       if (SgFunctionDeclaration* funcDecl = dynamic_cast<SgFunctionDeclaration*>(decl)) {
-        Function* func = new Function(new VariableTable);
-        program->addFunction(func);
-        handleSgFunction(funcDecl, func);
+        // unselected functions are not extracted at all
+        if (selector.selectsFunction(funcDecl->get_name().getString())) {
+          funcDecls.push_back(funcDecl);
+        }
       } else if (SgVariableDeclaration* var = dynamic_cast<SgVariableDeclaration*>(decl)) {
         handleVarDeclaration(var, program->getVariableTable());
       } else {
         std::stringstream ss;
         ss << decl->class_name() << " unsupported in LoopExtraction::handleSgGlobal\n";
-        Message::warning(ss.str());
+        Message::warning(ss.str(), ASTHelper::getLocation(decl));
+      }
+    }
+
+    // with a profile, hot functions are extracted first
+    // and cold ones are skipped with -le:profile-only
+    std::vector<size_t> order;
+    for (size_t i = 0; i < funcDecls.size(); ++i) {
+      if (!options.profileOnly || isHot(funcDecls[i])) {
+        order.push_back(i);
+      }
+    }
+    if (profile != nullptr) {
+      std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return profile->getWeight(funcDecls[a]) > profile->getWeight(funcDecls[b]);
+      });
+    }
+
+    // with -le:dedup-functions, a function with the fingerprint of one
+    // extracted before in this run only refers to it, see Fingerprint
+    std::map<size_t, std::string> sameAs;
+    std::vector<size_t> extracted;
+    for (size_t i : order) {
+      if (options.dedupFunctions) {
+        std::string ref = program->getName() + ":" + funcDecls[i]->get_name().getString();
+        auto inserted = fingerprints.insert(std::make_pair(Fingerprint::compute(funcDecls[i]), ref));
+        if (!inserted.second) {
+          sameAs[i] = inserted.first->second;
+          continue;
+        }
+      }
+      extracted.push_back(i);
+    }
+
+    std::vector<SgFunctionDeclaration*> tasks;
+    for (size_t i : extracted) {
+      tasks.push_back(funcDecls[i]);
+    }
+
+    if (options.jobs > 1 && tasks.size() > 1) {
+      std::vector<std::string>&& outputs = handleFunctionsInWorkers(tasks, program->getVariableTable());
+
+      // print functions in declaration order
+      std::map<size_t, std::string> byDecl;
+      for (size_t k = 0; k < extracted.size(); ++k) {
+        byDecl[extracted[k]] = outputs[k];
+      }
+      Printer* printer = createPrinter(program->getVariableTable());
+      for (auto& ref : sameAs) {
+        Function* func = new Function(new VariableTable);
+        func->setName(funcDecls[ref.first]->get_name().getString());
+        func->setSameAs(ref.second);
+        std::ostringstream oss;
+        printer->printFunction(oss, func, printer->getFunctionIndent());
+        byDecl[ref.first] = oss.str();
+        delete func;
+      }
+      delete printer;
+      for (auto& output : byDecl) {
+        functions.push_back(output.second);
+      }
+      return;
+    }
+
+    for (size_t i : order) {
+      Function* func = new Function(new VariableTable);
+      program->addFunction(func);
+      auto ref = sameAs.find(i);
+      if (ref != sameAs.end()) {
+        func->setName(funcDecls[i]->get_name().getString());
+        func->setSameAs(ref->second);
+      } else {
+        handleSgFunction(funcDecls[i], func);
+      }
+      if (callback) {
+        callback(program, func);
       }
     }
   }
@@ -552,34 +1147,205 @@ namespace LE {
 
     // extract file name without path and extension
     const std::string& fileName = src->getFileName();
+    TraceScope scope("file", fileName);
     int len = fileName.length();
     int index = len - 1;
     while (index >= 0 && fileName[index] != '/') --index;
 
+    calls.clear();
     VariableTable* varTbl = new VariableTable;
     Program* program = new Program(fileName.substr(index + 1), varTbl);
-    handleSgGlobal(global, program);
+    std::vector<std::string> functions;
+    handleSgGlobal(global, program, functions);
 
-    JsonPrinter printer;
-    printer.printProgram(std::cout, program);
+    if (options.omp) {
+      writeAnnotatedSource(src);
+    }
+
+    if (embedded) {
+      // a streamed AST is deleted before the next file,
+      // so its program is only seen by the callback
+      if (!options.stream) {
+        programs.push_back(program);
+      } else {
+        delete program;
+      }
+      return;
+    }
+
+    TraceScope print("print", fileName);
+    Printer* printer = createPrinter(varTbl);
+    if (functions.empty()) {
+      printer->printProgram(std::cout, program);
+    } else {
+      printer->printProgram(std::cout, program, functions);
+    }
+    delete printer;
+    delete program;
+  }
+
+  void LoopExtraction::writeAnnotatedSource(SgSourceFile* src) {
+    // 'dir/test.c' -> 'dir/test.omp.c'
+    std::string fileName = src->getFileName();
+    std::string::size_type slash = fileName.rfind('/');
+    std::string::size_type dot = fileName.rfind('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+      fileName += ".omp";
+    } else {
+      fileName.insert(dot, ".omp");
+    }
+
+    src->set_unparse_output_filename(fileName);
+    unparseFile(src);
   }
 
   void LoopExtraction::handleSgFileList(SgFileList* fileList) {
     std::vector<SgNode*> nodes = fileList->get_traversalSuccessorContainer();
     for (auto n : nodes) {
-      if (SgSourceFile *src = dynamic_cast<SgSourceFile*>(n)) {
+      SgSourceFile *src = dynamic_cast<SgSourceFile*>(n);
+      if (src != nullptr && selector.selectsFile(src->getFileName())) {
         handleSgSourceFile(src);
       }
     }
   }
 
+  void LoopExtraction::handleFilesInStream() {
+    std::vector<std::string> flags, files;
+    for (size_t i = 0; i < args.size(); ++i) {
+      const std::string& arg = args[i];
+      if (takesArgument(arg) && i + 1 < args.size()) {
+        // the value belongs to the flag, even if it names a source file
+        flags.push_back(arg);
+        flags.push_back(args[++i]);
+      } else if (isSourceFile(arg)) {
+        // unselected files are not even parsed
+        if (selector.selectsFile(arg)) {
+          files.push_back(arg);
+        }
+      } else {
+        flags.push_back(arg);
+      }
+    }
+
+    AstCache* cache = nullptr;
+    if (!options.cacheDir.empty()) {
+      cache = new AstCache(options.cacheDir);
+    }
+
+    // only one AST is alive at a time
+    // so peak memory is bounded by the largest file
+    for (const std::string& file : files) {
+      if (cache != nullptr) {
+        project = cache->load(flags, file);
+      } else {
+        TraceScope scope("frontend", file);
+        std::vector<std::string> fileArgs(flags);
+        fileArgs.push_back(file);
+        project = frontend(fileArgs);
+      }
+      handleSgFileList(project->get_fileList_ptr());
+
+      SageInterface::deleteAST(project);
+      project = nullptr;
+    }
+
+    delete cache;
+  }
+
   void LoopExtraction::handleSgProject() {
+    if (options.stream) {
+      handleFilesInStream();
+      return;
+    }
+
     SgFileList* fileList = project->get_fileList_ptr();
     handleSgFileList(fileList);
   }
 
-  LoopExtraction::LoopExtraction (int argc, char* argv[]) {
-    project = frontend(argc, argv);
+  SgProject* LoopExtraction::parse() {
+    TraceScope scope("frontend", "frontend");
+    return frontend(args);
+  }
+
+  void LoopExtraction::loadProfile() {
+    if (!options.profile.empty()) {
+      profile = new Profile;
+      if (!profile->load(options.profile)) {
+        Message::error("can't read profile " + options.profile);
+      }
+    }
+  }
+
+  std::vector<Program*> LoopExtraction::extractFiles(const std::vector<std::string>& files) {
+    // ROSE expects the name of the program first
+    args.assign(1, "le");
+    args.insert(args.end(), files.begin(), files.end());
+
+    if (options.stream) {
+      handleFilesInStream();
+    } else {
+      project = parse();
+      parsed.push_back(project);
+      handleSgFileList(project->get_fileList_ptr());
+      project = nullptr;
+    }
+
+    std::vector<Program*> result;
+    result.swap(programs);
+    return result;
+  }
+
+  std::vector<Program*> LoopExtraction::extractProject(SgProject* proj) {
+    project = proj;
+    handleSgFileList(project->get_fileList_ptr());
+    project = nullptr;
+
+    std::vector<Program*> result;
+    result.swap(programs);
+    return result;
+  }
+
+  LoopExtraction::LoopExtraction(const std::vector<std::string>& leOptions):
+    project(nullptr), embedded(true), profile(nullptr), returned(nullptr) {
+    std::vector<std::string> rest(leOptions);
+    options.parse(rest);
+    if (!rest.empty()) {
+      Message::error("not an option of le: " + rest.front());
+    }
+    selector = Selector(options);
+    Diagnostics::configure(options.diagFile, options.diagLimit);
+    Trace::configure(options.traceFile);
+    loadProfile();
+
+    // functions extracted in workers would only come back as text
+    options.jobs = 1;
+  }
+
+  LoopExtraction::LoopExtraction (int argc, char* argv[]):
+    project(nullptr), embedded(false), profile(nullptr), returned(nullptr) {
+    args.assign(argv, argv + argc);
+    options.parse(args);
+    selector = Selector(options);
+    Diagnostics::configure(options.diagFile, options.diagLimit);
+    Trace::configure(options.traceFile);
+    loadProfile();
+
+    // in stream mode, files are parsed one by one later
+    if (!options.stream) {
+      project = parse();
+    }
+  }
+
+  LoopExtraction::~LoopExtraction() {
+    // a project given to extractProject belongs to the caller
+    // and is no longer referred to here
+    if (project != nullptr) {
+      SageInterface::deleteAST(project);
+    }
+    for (SgProject* proj : parsed) {
+      SageInterface::deleteAST(proj);
+    }
+    delete profile;
   }
 
 }
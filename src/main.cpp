@@ -1,7 +1,14 @@
 #include "loopExtraction.h"
+#include "message.h"
+#include <iostream>
 
 int main(int argc, char *argv[]) {
-  LE::LoopExtraction le(argc, argv);
-  le.handleSgProject();
+  try {
+    LE::LoopExtraction le(argc, argv);
+    le.handleSgProject();
+  } catch (const LE::Error& e) {
+    std::cerr << "LOOP EXTRACTION ERROR: " << e.what() << std::endl;
+    return 1;
+  }
   return 0;
 }
@@ -2,11 +2,11 @@
 
 namespace LE {
 
-  int LoopNameAllocator::id = 1;
-  int PathNameAllocator::id = 1;
-  int BlockNameAllocator::id = 1;
+  long LoopNameAllocator::id = 1;
+  long PathNameAllocator::id = 1;
+  long BlockNameAllocator::id = 1;
 
-  static std::string allocName(const std::string& prefix, int& id) {
+  static std::string allocName(const std::string& prefix, long& id) {
     std::stringstream ss;
     ss << prefix;
     ss << std::to_string(id++);
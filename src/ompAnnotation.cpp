@@ -0,0 +1,250 @@
+#include "ompAnnotation.h"
+#include "astHelper.h"
+#include <sstream>
+
+namespace LE {
+
+  namespace {
+
+    bool isVar(SgExpression* expr, const std::string& name) {
+      SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr);
+      return var != nullptr && var->get_symbol()->get_name().getString() == name;
+    }
+
+    // operator of a reduction clause, empty if op can't reduce
+    // 's = s - e' is reduced with '+' as partial results are added
+    std::string getClauseOp(SgBinaryOp* binOp) {
+      if (dynamic_cast<SgAddOp*>(binOp) || dynamic_cast<SgSubtractOp*>(binOp)) return "+";
+      if (dynamic_cast<SgMultiplyOp*>(binOp)) return "*";
+      if (dynamic_cast<SgBitAndOp*>(binOp)) return "&";
+      if (dynamic_cast<SgBitOrOp*>(binOp)) return "|";
+      if (dynamic_cast<SgBitXorOp*>(binOp)) return "^";
+      if (dynamic_cast<SgAndOp*>(binOp)) return "&&";
+      if (dynamic_cast<SgOrOp*>(binOp)) return "||";
+      return "";
+    }
+
+    // index of a for loop in canonical form, set by its init, empty if none
+    std::string getIndex(Loop* loop) {
+      SgForStatement* forStmt = dynamic_cast<SgForStatement*>(loop->getStatement());
+      SgInitializedName* ivar = nullptr;
+      if (forStmt == nullptr || !SageInterface::isCanonicalForLoop(forStmt, &ivar) ||
+          ivar == nullptr) {
+        return "";
+      }
+      return ivar->get_name().getString();
+    }
+
+    std::string join(const std::set<std::string>& names) {
+      std::string result;
+      for (const std::string& name : names) {
+        if (!result.empty()) result += ", ";
+        result += name;
+      }
+      return result;
+    }
+
+  }
+
+  void OmpAnnotation::countRefs(SgExpression* expr, std::map<std::string, int>& refs) {
+    ASTHelper::traverse(expr, [&](SgExpression* node) {
+      if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(node)) {
+        ++refs[var->get_symbol()->get_name().getString()];
+      }
+      return true;
+    });
+  }
+
+  bool OmpAnnotation::getReductionOp(SgExpression* value, const std::string& name,
+                                     std::string& op) {
+    // walk down operands of the same operator, e.g. '((s - i) - p)'
+    op.clear();
+    SgExpression* expr = value;
+    while (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+      std::string&& clauseOp = getClauseOp(binOp);
+      if (clauseOp.empty() || (!op.empty() && clauseOp != op)) return false;
+      op = clauseOp;
+
+      if (isVar(binOp->get_lhs_operand(), name)) return true;
+      if (!dynamic_cast<SgSubtractOp*>(binOp) && isVar(binOp->get_rhs_operand(), name)) {
+        return true;
+      }
+      expr = binOp->get_lhs_operand();
+    }
+    return false;
+  }
+
+  bool OmpAnnotation::isStructured(SgForStatement* forStmt) {
+    if (!NodeQuery::querySubTree(forStmt, V_SgReturnStmt).empty() ||
+        !NodeQuery::querySubTree(forStmt, V_SgGotoStatement).empty()) {
+      return false;
+    }
+
+    // a call kept as it is may have any side effect
+    for (SgNode* node : NodeQuery::querySubTree(forStmt, V_SgFunctionCallExp)) {
+      SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(node);
+      if (call == nullptr || calls.isOpaque(call)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void OmpAnnotation::collect(Loop* loop, std::set<Loop*>& visited) {
+    if (!visited.insert(loop).second) return;
+
+    VariableTable* decls = loop->getVariableTable();
+    for (auto it = decls->begin(), ie = decls->end(); it != ie; ++it) {
+      declared.insert(it->first);
+      countRefs(it->second->getInitValue(), refs);
+    }
+
+    for (LoopPath* path : *loop) {
+      ConstraintList* cl = path->getConstraintList();
+      for (SgExpression* constraint : *cl) {
+        countRefs(constraint, refs);
+      }
+
+      VariableTable* varTbl = path->getVariableTable();
+      for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+        Variable* var = it->second;
+        countRefs(var->getValue(), refs);
+        countRefs(var->getTarget(), refs);
+        if (ASTHelper::isPlainName(it->first)) {
+          updates[it->first].push_back(var->getValue());
+        }
+      }
+    }
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      collect(inner, visited);
+    }
+  }
+
+  bool OmpAnnotation::buildPragma(Loop* loop, SgForStatement* forStmt, std::string& pragma) {
+    SgInitializedName* ivar = nullptr;
+    SgExpression* upper = nullptr;
+    if (!SageInterface::isCanonicalForLoop(forStmt, &ivar, nullptr, &upper) ||
+        ivar == nullptr || !isStructured(forStmt)) {
+      return false;
+    }
+
+    // the loop variable must be an induction variable
+    // and the bound must not change in the loop
+    std::string index = ivar->get_name().getString();
+    if (loop->getInductionVars().count(index) == 0) return false;
+
+    std::set<std::string> boundVars;
+    ASTHelper::collectVarNames(upper, boundVars);
+    const std::set<std::string>& invariants = loop->getInvariantVars();
+    for (const std::string& name : boundVars) {
+      if (invariants.count(name) == 0) return false;
+    }
+
+    int breaks = 0;
+    for (LoopPath* path : *loop) {
+      if (path->canBreakLoop()) ++breaks;
+    }
+    if (breaks > 1) return false;
+
+    for (const Dependence& dep : loop->getDependences()) {
+      if (dep.level == 1) return false;
+    }
+
+    refs.clear();
+    updates.clear();
+    declared.clear();
+    std::set<Loop*> visited;
+    collect(loop, visited);
+
+    // classify scalars carried from one iteration to the next
+    std::map<std::string, std::set<std::string> > reductions;
+    std::set<std::string> lastPrivates;
+    const std::set<std::string>& carried = loop->getCarriedScalars();
+    for (const std::string& name : carried) {
+      const std::vector<SgExpression*>& values = updates[name];
+
+      std::string op;
+      bool reduction = !values.empty() && refs[name] == static_cast<int>(values.size());
+      for (SgExpression* value : values) {
+        std::string valueOp;
+        if (!reduction || !getReductionOp(value, name, valueOp) ||
+            (!op.empty() && valueOp != op)) {
+          reduction = false;
+          break;
+        }
+        op = valueOp;
+      }
+      if (reduction) {
+        reductions[op].insert(name);
+        continue;
+      }
+
+      // a scalar never read must be written in every iteration,
+      // then its value after the loop is that of the last iteration
+      if (refs[name] > 0) return false;
+      for (LoopPath* path : *loop) {
+        if (!path->canBreakLoop() && path->getVariableTable()->getVariable(name) == nullptr) {
+          return false;
+        }
+      }
+      lastPrivates.insert(name);
+    }
+
+    // induction variables of inner loops declared outside the loop
+    std::set<std::string> privates;
+    for (auto& update : updates) {
+      const std::string& name = update.first;
+      if (name != index && declared.count(name) == 0 && carried.count(name) == 0) {
+        privates.insert(name);
+      }
+    }
+
+    // other induction variables keep their value from one iteration to
+    // the next, e.g. 'j' in 'for (i = 0; i < n; ++i) { j += 2; a[j] = 0; }',
+    // only indices of inner loops are set again in every iteration
+    for (Loop* nested : visited) {
+      std::string&& nestedIndex = getIndex(nested);
+      for (auto& induction : nested->getInductionVars()) {
+        if (privates.count(induction.first) > 0 && induction.first != nestedIndex) {
+          return false;
+        }
+      }
+    }
+
+    std::ostringstream oss;
+    oss << "omp parallel for";
+    if (!privates.empty()) {
+      oss << " private(" << join(privates) << ")";
+    }
+    if (!lastPrivates.empty()) {
+      oss << " lastprivate(" << join(lastPrivates) << ")";
+    }
+    for (auto& reduction : reductions) {
+      oss << " reduction(" << reduction.first << ": " << join(reduction.second) << ")";
+    }
+    pragma = oss.str();
+    return true;
+  }
+
+  int OmpAnnotation::annotate(Loop* loop) {
+    SgForStatement* forStmt = dynamic_cast<SgForStatement*>(loop->getStatement());
+    if (forStmt != nullptr && annotated.count(forStmt) > 0) return 0;
+
+    std::string pragma;
+    if (forStmt != nullptr && buildPragma(loop, forStmt, pragma)) {
+      SgPragmaDeclaration* pragmaDecl =
+        SageBuilder::buildPragmaDeclaration(pragma, forStmt->get_scope());
+      SageInterface::insertStatementBefore(forStmt, pragmaDecl);
+      annotated.insert(forStmt);
+      return 1;
+    }
+
+    int count = 0;
+    for (Loop* inner : loop->getInnerLoops()) {
+      count += annotate(inner);
+    }
+    return count;
+  }
+
+}
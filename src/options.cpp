@@ -0,0 +1,165 @@
+#include "options.h"
+#include "message.h"
+#include <cstdlib>
+
+namespace LE {
+
+  // prefix of every option of loop extraction
+  static const std::string prefix = "-le:";
+
+  // parse a positive integer value of an option
+  static int parsePositive(const std::string& option, const std::string& value) {
+    char* end = nullptr;
+    long n = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || n <= 0) {
+      Message::error("invalid value of option " + option + ": '" + value + "'");
+    }
+    return static_cast<int>(n);
+  }
+
+  // sections that can be selected with -le:sections
+  static const std::set<std::string> knownSections = {
+    "variables", "initialize", "input_variables", "paths",
+    "constraints", "returns", "blocks", "loops"
+  };
+
+  // parse a non-negative number value of an option
+  static double parseNonNegative(const std::string& option, const std::string& value) {
+    char* end = nullptr;
+    double d = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || d < 0) {
+      Message::error("invalid value of option " + option + ": '" + value + "'");
+    }
+    return d;
+  }
+
+  void Options::parse(std::vector<std::string>& args) {
+    std::vector<std::string> rest;
+    for (const std::string& arg : args) {
+      if (arg.compare(0, prefix.length(), prefix) != 0) {
+        rest.push_back(arg);
+        continue;
+      }
+
+      // split option into name and value, e.g. 'jobs=4' -> 'jobs', '4'
+      std::string option = arg.substr(prefix.length());
+      std::string value;
+      std::string::size_type eq = option.find('=');
+      if (eq != std::string::npos) {
+        value = option.substr(eq + 1);
+        option = option.substr(0, eq);
+      }
+
+      if (option == "jobs") {
+        jobs = parsePositive(arg, value);
+      } else if (option == "stream") {
+        stream = true;
+      } else if (option == "cache") {
+        if (value.empty()) {
+          Message::error("option " + arg + " needs a directory");
+        }
+        cacheDir = value;
+        stream = true;
+      } else if (option == "keep-dead") {
+        keepDead = true;
+      } else if (option == "no-coalesce") {
+        noCoalesce = true;
+      } else if (option == "no-dedup") {
+        noDedup = true;
+      } else if (option == "dedup-functions") {
+        dedupFunctions = true;
+      } else if (option == "regions") {
+        regions = true;
+      } else if (option == "fast") {
+        fast = true;
+      } else if (option == "witnesses") {
+        // e.g. '-le:witnesses' or '-le:witnesses=100000'
+        witnesses = value.empty() ? 65536 : parsePositive(arg, value);
+      } else if (option == "ranges") {
+        ranges = true;
+      } else if (option == "format") {
+        if (value != "json" && value != "smt2" && value != "sqlite") {
+          Message::error("invalid value of option " + arg + ": '" + value + "'");
+        }
+        format = value;
+      } else if (option == "db") {
+        if (value.empty()) {
+          Message::error("option " + arg + " needs a file");
+        }
+        db = value;
+      } else if (option == "layout") {
+        if (value != "flat" && value != "tree") {
+          Message::error("invalid value of option " + arg + ": '" + value + "'");
+        }
+        layout = value;
+      } else if (option == "diag-file") {
+        if (value.empty()) {
+          Message::error("option " + arg + " needs a file");
+        }
+        diagFile = value;
+      } else if (option == "diag-limit") {
+        diagLimit = parsePositive(arg, value);
+      } else if (option == "trace") {
+        if (value.empty()) {
+          Message::error("option " + arg + " needs a file");
+        }
+        traceFile = value;
+      } else if (option == "omp") {
+        omp = true;
+      } else if (option == "profile") {
+        if (value.empty()) {
+          Message::error("option " + arg + " needs a file");
+        }
+        profile = value;
+      } else if (option == "profile-threshold") {
+        profileThreshold = parseNonNegative(arg, value);
+      } else if (option == "profile-only") {
+        profileOnly = true;
+      } else if (option == "function") {
+        if (value.empty()) {
+          Message::error("option " + arg + " needs a pattern");
+        }
+        functions.push_back(value);
+      } else if (option == "file") {
+        if (value.empty()) {
+          Message::error("option " + arg + " needs a pattern");
+        }
+        files.push_back(value);
+      } else if (option == "sections") {
+        // e.g. 'paths,loops'
+        std::string::size_type begin = 0;
+        while (begin <= value.length()) {
+          std::string::size_type end = value.find(',', begin);
+          if (end == std::string::npos) end = value.length();
+          std::string section = value.substr(begin, end - begin);
+          if (knownSections.count(section) == 0) {
+            Message::error("invalid value of option " + arg + ": '" + section + "'");
+          }
+          sections.insert(section);
+          begin = end + 1;
+        }
+      } else {
+        Message::error("unknown option " + arg);
+      }
+    }
+
+    // pragmas inserted by forked workers would be lost with their ASTs
+    if (omp) {
+      jobs = 1;
+    }
+
+    // rows are written by this process, workers only return text
+    if (format == "sqlite") {
+      if (db.empty()) {
+        Message::error("option " + prefix + "format=sqlite needs " + prefix + "db");
+      }
+      jobs = 1;
+    }
+
+    if (profileOnly && profile.empty()) {
+      Message::error("option " + prefix + "profile-only needs " + prefix + "profile");
+    }
+    args.swap(rest);
+  }
+
+}
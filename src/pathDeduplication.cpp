@@ -0,0 +1,155 @@
+#include "pathDeduplication.h"
+#include "astHelper.h"
+#include "printer.h"
+#include <functional>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace LE {
+
+  std::string PathDeduplication::fingerprint(Path* path) {
+    std::ostringstream oss;
+    JsonPrinter printer;
+    for (const std::string& element : path->getPaths()) {
+      oss << element << ',';
+    }
+    oss << (path->isPathReturn() ? "|return:" : "|end:");
+    if (path->getReturnValue() != nullptr) {
+      printer.printExpression(oss, path->getReturnValue());
+    }
+
+    // constraints are merged into one, so they must be checked at one step
+    // a path checking them at several steps is never merged
+    ConstraintList* cl = path->getConstraints();
+    oss << "|at:";
+    for (size_t i = 0; i < cl->size(); ++i) {
+      if (cl->getStep(i) != cl->getStep(0)) return oss.str() + path->getName();
+    }
+    if (cl->size() > 0) {
+      oss << cl->getStep(0);
+    }
+    return oss.str();
+  }
+
+  std::string PathDeduplication::fingerprint(LoopPath* path) {
+    std::ostringstream oss;
+    JsonPrinter printer;
+    VariableTable* varTbl = path->getVariableTable();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      // the target of 'a[i]' has the subscript of the write, which differs
+      // between paths that updated 'i' before
+      oss << it->first << '@';
+      if (it->second->getTarget() != nullptr) {
+        printer.printExpression(oss, it->second->getTarget());
+      }
+      oss << '=';
+      printer.printExpression(oss, it->second->getValue());
+      oss << ';';
+    }
+    oss << '|';
+    for (const std::string& loop : path->getInnerLoops()) {
+      oss << loop << ',';
+    }
+    oss << (path->canBreakLoop() ? "|break" : "|continue");
+    return oss.str();
+  }
+
+  SgExpression* PathDeduplication::conjunction(ConstraintList* cl) {
+    SgExpression* result = nullptr;
+    for (SgExpression* constraint : *cl) {
+      SgExpression* c = ASTHelper::clone(constraint);
+      result = result == nullptr ? c :
+        new SgAndOp(result, c, SgTypeBool::createType());
+    }
+    return result;
+  }
+
+  ConstraintList* PathDeduplication::disjunction(ConstraintList* first,
+                                                 ConstraintList* second, size_t step) {
+    SgExpression* lhs = conjunction(first);
+    SgExpression* rhs = conjunction(second);
+
+    // an empty list always holds, so does the disjunction
+    ConstraintList* result = new ConstraintList;
+    if (lhs != nullptr && rhs != nullptr) {
+      result->addConstraint(new SgOrOp(lhs, rhs, SgTypeBool::createType()), step);
+    }
+    return result;
+  }
+
+  int PathDeduplication::deduplicate(Loop* loop) {
+    int merged = 0;
+    std::unordered_map<size_t, std::vector<std::pair<std::string, LoopPath*> > > buckets;
+    std::hash<std::string> hash;
+
+    for (LoopPath* path : loop->getPaths()) {
+      std::string&& key = fingerprint(path);
+      std::vector<std::pair<std::string, LoopPath*> >& bucket = buckets[hash(key)];
+
+      LoopPath* same = nullptr;
+      for (auto& entry : bucket) {
+        if (entry.first == key) {
+          same = entry.second;
+          break;
+        }
+      }
+
+      if (same == nullptr) {
+        bucket.push_back(std::make_pair(key, path));
+      } else {
+        // constraints are cloned into the disjunction
+        ConstraintList* cl = same->getConstraintList();
+        same->setConstraintList(disjunction(cl, path->getConstraintList()));
+        delete cl;
+        loop->removePath(path);
+        delete path;
+        ++merged;
+      }
+    }
+    loop->addMergedPaths(merged);
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      merged += deduplicate(inner);
+    }
+    return merged;
+  }
+
+  int PathDeduplication::deduplicate(Function* func) {
+    int merged = 0;
+    std::unordered_map<size_t, std::vector<std::pair<std::string, Path*> > > buckets;
+    std::hash<std::string> hash;
+
+    for (Path* path : func->getPaths()) {
+      std::string&& key = fingerprint(path);
+      std::vector<std::pair<std::string, Path*> >& bucket = buckets[hash(key)];
+
+      Path* same = nullptr;
+      for (auto& entry : bucket) {
+        if (entry.first == key) {
+          same = entry.second;
+          break;
+        }
+      }
+
+      if (same == nullptr) {
+        bucket.push_back(std::make_pair(key, path));
+      } else {
+        ConstraintList* cl = same->getConstraints();
+        size_t step = cl->size() > 0 ? cl->getStep(0) : 0;
+        same->setConstraints(disjunction(cl, path->getConstraints(), step));
+        delete cl;
+        func->removePath(path);
+        delete path;
+        ++merged;
+      }
+    }
+    func->addMergedPaths(merged);
+
+    for (Loop* loop : func->getLoops()) {
+      merged += deduplicate(loop);
+    }
+    return merged;
+  }
+
+}
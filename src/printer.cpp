@@ -2,8 +2,10 @@
 #include "astHelper.h"
 #include "message.h"
 #include <cassert>
+#include <iomanip>
 #include <set>
 #include <sstream>
+#include <vector>
 
 namespace LE {
 
@@ -15,70 +17,123 @@ namespace LE {
     return ss.str();
   }
 
+  namespace {
+
+    // a part of an expression left to print
+    // text is printed as is, an operator as ' op ' between operands
+    struct Piece {
+      enum Kind { EXPRESSION, TEXT, OPERATOR } kind;
+      SgExpression* expr;
+      const char* text;
+
+      static Piece expression(SgExpression* e) { return Piece{EXPRESSION, e, nullptr}; }
+      static Piece literal(const char* t) { return Piece{TEXT, nullptr, t}; }
+      static Piece op(SgExpression* e) { return Piece{OPERATOR, e, nullptr}; }
+    };
+
+  }
+
   void Printer::printExpression(std::ostream& os, SgExpression* expr) {
-    if (expr == nullptr) {
-      os << "[NULL]";
-      return;
-    }
+    // pieces are printed from the back, so operands are pushed in reverse
+    // an explicit stack instead of recursion, as generated code
+    // may nest expressions thousands of levels deep
+    std::vector<Piece> stack;
+    stack.push_back(Piece::expression(expr));
+
+    while (!stack.empty()) {
+      Piece piece = stack.back();
+      stack.pop_back();
+
+      if (piece.kind == Piece::TEXT) {
+        os << piece.text;
+        continue;
+      }
+      if (piece.kind == Piece::OPERATOR) {
+        os << " " << ASTHelper::getOperatorString(piece.expr->variantT()) << " ";
+        continue;
+      }
 
-    // if expr is a constant, print its value
-    if (SgValueExp* value = dynamic_cast<SgValueExp*>(expr)) {
-      os << value->get_constant_folded_value_as_string();
-      return;
-    }
+      expr = piece.expr;
+      if (expr == nullptr) {
+        os << "[NULL]";
+        continue;
+      }
 
-    // if expr is a variable, print its name
-    if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr)) {
-      os << var->get_symbol()->get_name().getString();
-      return;
-    }
+      if (printTerm(os, expr)) continue;
 
-    // if expr is a binary expression
-    if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
-      // array expression is handled differently from other binary operator
-      if (SgPntrArrRefExp* arrRef = dynamic_cast<SgPntrArrRefExp*>(binOp)) {
-        printExpression(os, arrRef->get_lhs_operand());
-        os << "[";
-        printExpression(os, arrRef->get_rhs_operand());
-        os << "]";
-      } else {
-        os << "(";
-        printExpression(os, binOp->get_lhs_operand());
-        os << " " << ASTHelper::getOperatorString(binOp->variantT()) << " ";
-        printExpression(os, binOp->get_rhs_operand());
-        os << ")";
+      // if expr is a constant, print its value
+      if (SgValueExp* value = dynamic_cast<SgValueExp*>(expr)) {
+        os << value->get_constant_folded_value_as_string();
+        continue;
+      }
+
+      // if expr is a variable, print its name
+      if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr)) {
+        os << var->get_symbol()->get_name().getString();
+        continue;
       }
-    } else if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(expr)) {
-      // unary operation
-      os << "(";
-      if (dynamic_cast<SgPlusPlusOp*>(unaryOp)) {
-        // ++
-        printExpression(os, unaryOp->get_operand());
-        os << " + 1";
-      } else if (dynamic_cast<SgMinusMinusOp*>(unaryOp)) {
-        // --
-        printExpression(os, unaryOp->get_operand());
-        os << " - 1";
-      } else if (SgCastExp* castExp = dynamic_cast<SgCastExp*>(unaryOp)) {
-        // cast
-        printExpression(os, castExp->get_operand());
+
+      // if expr is a binary expression
+      if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+        // array expression is handled differently from other binary operator
+        if (SgPntrArrRefExp* arrRef = dynamic_cast<SgPntrArrRefExp*>(binOp)) {
+          stack.push_back(Piece::literal("]"));
+          stack.push_back(Piece::expression(arrRef->get_rhs_operand()));
+          stack.push_back(Piece::literal("["));
+          stack.push_back(Piece::expression(arrRef->get_lhs_operand()));
+        } else {
+          os << "(";
+          stack.push_back(Piece::literal(")"));
+          stack.push_back(Piece::expression(binOp->get_rhs_operand()));
+          stack.push_back(Piece::op(binOp));
+          stack.push_back(Piece::expression(binOp->get_lhs_operand()));
+        }
+      } else if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(expr)) {
+        // unary operation
+        os << "(";
+        stack.push_back(Piece::literal(")"));
+        if (dynamic_cast<SgPlusPlusOp*>(unaryOp)) {
+          // ++
+          stack.push_back(Piece::literal(" + 1"));
+        } else if (dynamic_cast<SgMinusMinusOp*>(unaryOp)) {
+          // --
+          stack.push_back(Piece::literal(" - 1"));
+        } else if (!dynamic_cast<SgCastExp*>(unaryOp)) {
+          // casts print their operand only
+          os << ASTHelper::getOperatorString(unaryOp->variantT());
+        }
+        stack.push_back(Piece::expression(unaryOp->get_operand()));
+      } else if (SgAssignInitializer* initializer = dynamic_cast<SgAssignInitializer*>(expr)) {
+        // assign initializer
+        stack.push_back(Piece::expression(initializer->get_operand()));
+      } else if (SgConditionalExp* condExp = dynamic_cast<SgConditionalExp*>(expr)) {
+        // conditional, e.g. from summaries of callees
+        os << "(";
+        stack.push_back(Piece::literal(")"));
+        stack.push_back(Piece::expression(condExp->get_false_exp()));
+        stack.push_back(Piece::literal(" : "));
+        stack.push_back(Piece::expression(condExp->get_true_exp()));
+        stack.push_back(Piece::literal(" ? "));
+        stack.push_back(Piece::expression(condExp->get_conditional_exp()));
+      } else if (SgFunctionCallExp* call = dynamic_cast<SgFunctionCallExp*>(expr)) {
+        // call that is not summarized
+        SgFunctionDeclaration* decl = call->getAssociatedFunctionDeclaration();
+        os << (decl != nullptr ? decl->get_name().getString() : call->get_function()->unparseToString());
+        os << "(";
+        stack.push_back(Piece::literal(")"));
+        std::vector<SgExpression*>& args = call->get_args()->get_expressions();
+        for (size_t i = args.size(); i > 0; --i) {
+          stack.push_back(Piece::expression(args[i - 1]));
+          if (i > 1) stack.push_back(Piece::literal(", "));
+        }
       } else {
-        os << ASTHelper::getOperatorString(unaryOp->variantT());
-        printExpression(os, unaryOp->get_operand());
+        std::stringstream ss;
+        ss << expr->class_name() << " unsupported in Printer::printExpression\n";
+        Message::warning(ss.str(), ASTHelper::getLocation(expr));
       }
-      os << ")";
-    } else if (SgAssignInitializer* initializer = dynamic_cast<SgAssignInitializer*>(expr)) {
-      // assign initializer
-      SgExpression* operand = initializer->get_operand();
-      printExpression(os, operand);
-    } else {
-      std::stringstream ss;
-      ss << expr->class_name() << " unsupported in Printer::printExpression\n";
-      Message::warning(ss.str());
     }
   }
 
-  //
   // void NormalPrinter::printInnerLoops(std::ostream& os, const std::set<std::string>& loopNames) {
   //   os << indent << "inner loop: {";
   //   if (loopNames.empty()) {
@@ -128,6 +183,15 @@ namespace LE {
     }
   }
 
+  void JsonPrinter::printConstraintSteps(std::ostream& os, ConstraintList* cl, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'constraint_steps': [";
+    for (size_t i = 0; i < cl->size(); ++i) {
+      os << (i == 0 ? " " : ", ") << cl->getStep(i);
+    }
+    os << (cl->size() == 0 ? "]" : " ]");
+  }
+
   void JsonPrinter::printVarDecl(std::ostream& os, VariableTable* varTbl, int indentLv) {
     std::string&& indent = getIndent(indentLv);
     os << indent << "'variables': {";
@@ -196,6 +260,73 @@ namespace LE {
     }
   }
 
+  void JsonPrinter::printInvariantVars(std::ostream& os,
+                                      const std::set<std::string>& vars,
+                                      int indentLv) {
+    printNames(os, "invariant_variables", vars, indentLv);
+  }
+
+  void JsonPrinter::printNames(std::ostream& os, const std::string& key,
+                               const std::set<std::string>& names, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'" << key << "': [";
+    auto it = names.begin(), ie = names.end();
+    if (it == ie) {
+      os << "]";
+    } else {
+      while (it != ie) {
+        const std::string& name = *(it++);
+        os << " '" << name << "'";
+        os << (it == ie ? " ]" : ",");
+      }
+    }
+  }
+
+  void JsonPrinter::printAccess(std::ostream& os, const Access& access, int indentLv) {
+    printNames(os, "may_read", access.mayRead, indentLv);
+    os << ",\n";
+    printNames(os, "may_modify", access.mayModify, indentLv);
+  }
+
+  void JsonPrinter::printAccesses(std::ostream& os, const std::map<std::string, Access>& accesses,
+                                  int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'accesses': {";
+    auto it = accesses.begin(), ie = accesses.end();
+    if (it == ie) {
+      os << "}";
+    } else {
+      os << '\n';
+      while (it != ie) {
+        const std::string& name = it->first;
+        const Access& access = (it++)->second;
+        os << getIndent(indentLv + 1) << "'" << name << "': {\n";
+        printAccess(os, access, indentLv + 2);
+        os << '\n' << getIndent(indentLv + 1) << "}" << (it == ie ? "\n" : ",\n");
+      }
+      os << indent << "}";
+    }
+  }
+
+  void JsonPrinter::printInvariantExprs(std::ostream& os,
+                                       const std::vector<SgExpression*>& exprs,
+                                       int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'invariant_expressions': [";
+    auto it = exprs.begin(), ie = exprs.end();
+    if (it == ie) {
+      os << "]";
+    } else {
+      while (it != ie) {
+        SgExpression* expr = *(it++);
+        os << " '";
+        printExpression(os, expr);
+        os << "'";
+        os << (it == ie ? " ]" : ",");
+      }
+    }
+  }
+
   void JsonPrinter::printReturnValue(std::ostream& os, SgExpression* retVal, int indentLv) {
     std::string&& indent = getIndent(indentLv);
     os << indent << "'return': '";
@@ -203,6 +334,109 @@ namespace LE {
     os << "'";
   }
 
+  void JsonPrinter::printDependences(std::ostream& os,
+                                     const std::vector<Dependence>& deps,
+                                     int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    std::string&& depIndent = getIndent(indentLv + 1);
+    os << indent << "'dependences': [";
+    auto it = deps.begin(), ie = deps.end();
+    if (it == ie) {
+      os << "]";
+      return;
+    }
+
+    os << '\n';
+    while (it != ie) {
+      const Dependence& dep = *(it++);
+      os << depIndent << "{ 'kind': '" << dep.kind << "', 'array': '" << dep.array
+         << "', 'source': '" << dep.source << "', 'sink': '" << dep.sink
+         << "', 'distance': [";
+      for (size_t i = 0; i < dep.distance.size(); ++i) {
+        os << (i == 0 ? " '" : ", '") << dep.distance[i] << "'";
+      }
+      os << " ], 'direction': [";
+      for (size_t i = 0; i < dep.direction.size(); ++i) {
+        os << (i == 0 ? " '" : ", '") << dep.direction[i] << "'";
+      }
+      os << " ], 'level': " << dep.level << " }";
+      os << (it == ie ? "\n" : ",\n");
+    }
+    os << indent << "]";
+  }
+
+  void JsonPrinter::printCarriedScalars(std::ostream& os,
+                                        const std::set<std::string>& vars,
+                                        int indentLv) {
+    printNames(os, "carried_scalars", vars, indentLv);
+  }
+
+  void JsonPrinter::printParallel(std::ostream& os, bool parallel, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'parallel': '" << (parallel ? "true" : "false") << "'";
+  }
+
+  void JsonPrinter::printWitness(std::ostream& os, Path* path, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'witness': ";
+    if (!path->hasWitness()) {
+      os << "'none'";
+      return;
+    }
+
+    const std::map<std::string, double>& witness = path->getWitness();
+    os << "{";
+    auto it = witness.begin(), ie = witness.end();
+    if (it == ie) {
+      os << "}";
+    } else {
+      while (it != ie) {
+        const std::string& name = it->first;
+        std::ostringstream oss;
+        oss << std::setprecision(17) << (it++)->second;
+        os << " '" << name << "': '" << oss.str() << "'";
+        os << (it == ie ? " }" : ",");
+      }
+    }
+  }
+
+  void JsonPrinter::printRanges(std::ostream& os, const std::map<std::string, Interval>& ranges,
+                                int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'ranges': {";
+    auto it = ranges.begin(), ie = ranges.end();
+    if (it == ie) {
+      os << "}";
+    } else {
+      while (it != ie) {
+        const std::string& name = it->first;
+        std::ostringstream oss;
+        oss << std::setprecision(17) << "[" << it->second.lo << ", " << it->second.hi << "]";
+        ++it;
+        os << " '" << name << "': '" << oss.str() << "'";
+        os << (it == ie ? " }" : ",");
+      }
+    }
+  }
+
+  void JsonPrinter::printPathRanges(std::ostream& os, Path* path, int indentLv) {
+    if (path->isInfeasible()) {
+      os << getIndent(indentLv) << "'ranges': 'infeasible'";
+    } else {
+      printRanges(os, path->getRanges(), indentLv);
+    }
+  }
+
+  void JsonPrinter::printMergedPaths(std::ostream& os, int merged, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'merged_paths': " << merged;
+  }
+
+  void JsonPrinter::printProfileWeight(std::ostream& os, double weight, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'profile_weight': " << weight;
+  }
+
   void JsonPrinter::printLoopPath(std::ostream& os, const std::set<std::string>& innerLoops,
                                   VariableTable* varTbl, int indentLv) {
     std::string&& indent = getIndent(indentLv);
@@ -261,10 +495,7 @@ namespace LE {
     }
   }
 
-  void JsonPrinter::printLoop(std::ostream& os, Loop* loop, std::set<Loop*>& printed, int indentLv) {
-    if (printed.find(loop) != printed.end()) return;
-
-    printed.insert(loop);
+  void JsonPrinter::printLoopEntry(std::ostream& os, Loop* loop, int indentLv) {
     std::string&& indent = getIndent(indentLv);
     os << indent << "'" << loop->getName() << "': {\n";
 
@@ -274,25 +505,57 @@ namespace LE {
     printVarInit(os, loop->getVariableTable(), indentLv + 1);
     os << ",\n";
 
-    printLoopPaths(os, loop->getPaths(), indentLv + 1);
-    os << '\n';
+    printInvariantVars(os, loop->getInvariantVars(), indentLv + 1);
+    os << ",\n";
 
-    os << indent << "}";
+    printInvariantExprs(os, loop->getInvariantExprs(), indentLv + 1);
+    os << ",\n";
+
+    printDependences(os, loop->getDependences(), indentLv + 1);
+    os << ",\n";
+
+    printCarriedScalars(os, loop->getCarriedScalars(), indentLv + 1);
+    os << ",\n";
 
-    const std::set<Loop*>& innerLoops = loop->getInnerLoops();
-    if (!innerLoops.empty()) {
+    printParallel(os, loop->isParallel(), indentLv + 1);
+    os << ",\n";
+
+    // ranges are computed with -le:ranges only
+    if (!loop->getRanges().empty()) {
+      printRanges(os, loop->getRanges(), indentLv + 1);
       os << ",\n";
-      printInnerLoops(os, innerLoops, printed, indentLv);
     }
+
+    printLoopPaths(os, loop->getPaths(), indentLv + 1);
+    if (loop->getMergedPaths() > 0) {
+      os << ",\n";
+      printMergedPaths(os, loop->getMergedPaths(), indentLv + 1);
+    }
+    os << '\n';
+
+    os << indent << "}";
   }
 
-  void JsonPrinter::printInnerLoops(std::ostream& os, const std::set<Loop*>& loops,
-                                    std::set<Loop*>& printed, int indentLv) {
-    auto it = loops.begin(), ie = loops.end();
-    while (it != ie) {
-      Loop* loop = *(it++);
-      printLoop(os, loop, printed, indentLv);
-      if (it != ie) os << ",\n";
+  void JsonPrinter::printLoop(std::ostream& os, Loop* loop, std::set<Loop*>& printed, int indentLv) {
+    // a loop is followed by its inner loops, each after a comma
+    // nullptr on the stack stands for the comma
+    std::vector<Loop*> stack(1, loop);
+    while (!stack.empty()) {
+      Loop* top = stack.back();
+      stack.pop_back();
+      if (top == nullptr) {
+        os << ",\n";
+        continue;
+      }
+      if (!printed.insert(top).second) continue;
+
+      printLoopEntry(os, top, indentLv);
+
+      const std::set<Loop*>& innerLoops = top->getInnerLoops();
+      for (auto it = innerLoops.rbegin(), ie = innerLoops.rend(); it != ie; ++it) {
+        stack.push_back(*it);
+        stack.push_back(nullptr);
+      }
     }
   }
 
@@ -336,13 +599,47 @@ namespace LE {
     std::string&& indent = getIndent(indentLv);
     os << indent << "'" + path->getName() << "': {\n";
 
-    printConstraints(os, path->getConstraints(), indentLv + 1);
-    os << ",\n";
+    // with sections 'constraints' or 'returns' but not 'paths'
+    // only those fields are printed
+    bool all = hasSection("paths");
+    std::string sep;
+    if (all || hasSection("constraints")) {
+      ConstraintList* cl = path->getConstraints();
+      printConstraints(os, cl, indentLv + 1);
+      sep = ",\n";
+
+      // constraints all checked at the start of the path are the usual case
+      for (size_t i = 0; i < cl->size(); ++i) {
+        if (cl->getStep(i) > 0) {
+          os << sep;
+          printConstraintSteps(os, cl, indentLv + 1);
+          break;
+        }
+      }
+    }
 
-    printPaths(os, path->getPaths(), indentLv + 1);
-    os << ",\n";
+    if (all) {
+      os << sep;
+      printPaths(os, path->getPaths(), indentLv + 1);
+      sep = ",\n";
+    }
+
+    if (all || hasSection("returns")) {
+      os << sep;
+      printReturnValue(os, path->getReturnValue(), indentLv + 1);
+      sep = ",\n";
+    }
 
-    printReturnValue(os, path->getReturnValue(), indentLv + 1);
+    if ((all || hasSection("constraints")) && path->isWitnessSearched()) {
+      os << sep;
+      printWitness(os, path, indentLv + 1);
+      sep = ",\n";
+    }
+
+    if ((all || hasSection("constraints")) && path->isRangesAnalyzed()) {
+      os << sep;
+      printPathRanges(os, path, indentLv + 1);
+    }
     os << '\n';
 
     os << indent << "}";
@@ -405,27 +702,103 @@ namespace LE {
     std::string&& indent = getIndent(indentLv);
     os << indent << "'" << func->getName() << "': {\n";
 
-    printVarDecl(os, func->getVariableTable(), indentLv + 1);
-    os << ",\n";
+    // a function extracted before in this run is only referred to
+    if (!func->getSameAs().empty()) {
+      os << getIndent(indentLv + 1) << "'same_as': '" << func->getSameAs() << "'\n";
+      os << indent << "}";
+      return;
+    }
 
-    printVarInit(os, func->getVariableTable(), indentLv + 1);
-    os << ",\n";
+    // selected sections are separated by ',\n'
+    std::string sep;
+    if (hasSection("variables")) {
+      printVarDecl(os, func->getVariableTable(), indentLv + 1);
+      sep = ",\n";
+    }
 
-    printFuncParam(os, func->getParams(), indentLv + 1);
-    os << ",\n";
+    if (hasSection("initialize")) {
+      os << sep;
+      printVarInit(os, func->getVariableTable(), indentLv + 1);
+      sep = ",\n";
+    }
 
-    printPaths(os, func->getPaths(), indentLv + 1);
-    os << ",\n";
+    if (hasSection("input_variables")) {
+      os << sep;
+      printFuncParam(os, func->getParams(), indentLv + 1);
+      sep = ",\n";
+    }
 
-    printBlocks(os, func->getBlocks(), indentLv + 1);
-    os << ",\n";
+    // regions hold the sections of paths, blocks and loops
+    bool scoped = hasSection("paths") || hasSection("constraints") || hasSection("returns") ||
+                  hasSection("blocks") || hasSection("loops");
+    if (func->getRegions().empty()) {
+      printScope(os, func, sep, indentLv + 1);
+    } else if (scoped) {
+      os << sep;
+      printRegions(os, func->getRegions(), indentLv + 1);
+      sep = ",\n";
+    }
 
-    printLoops(os, func->getLoops(), indentLv + 1);
+    // accesses are collected with -le:fast only
+    const Access& access = func->getAccess();
+    if (!func->getAccesses().empty() || !access.mayRead.empty() || !access.mayModify.empty()) {
+      os << sep;
+      printAccess(os, access, indentLv + 1);
+      os << ",\n";
+      printAccesses(os, func->getAccesses(), indentLv + 1);
+      sep = ",\n";
+    }
+
+    if (func->getProfileWeight() >= 0) {
+      os << sep;
+      printProfileWeight(os, func->getProfileWeight(), indentLv + 1);
+    }
     os << '\n';
 
     os << indent << "}";
   }
 
+  void JsonPrinter::printScope(std::ostream& os, Function* scope, std::string& sep, int indentLv) {
+    bool paths = hasSection("paths") || hasSection("constraints") || hasSection("returns");
+    if (paths) {
+      os << sep;
+      printPaths(os, scope->getPaths(), indentLv);
+      sep = ",\n";
+    }
+
+    if (hasSection("blocks")) {
+      os << sep;
+      printBlocks(os, scope->getBlocks(), indentLv);
+      sep = ",\n";
+    }
+
+    if (hasSection("loops")) {
+      os << sep;
+      printLoops(os, scope->getLoops(), indentLv);
+      sep = ",\n";
+    }
+
+    // merged paths are counted with the paths
+    if (paths && scope->getMergedPaths() > 0) {
+      os << sep;
+      printMergedPaths(os, scope->getMergedPaths(), indentLv);
+      sep = ",\n";
+    }
+  }
+
+  void JsonPrinter::printRegions(std::ostream& os, const std::vector<Function*>& regions, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    std::string&& regionIndent = getIndent(indentLv + 1);
+    os << indent << "'regions': {\n";
+    for (size_t i = 0; i < regions.size(); ++i) {
+      os << regionIndent << "'" << regions[i]->getName() << "': {\n";
+      std::string sep;
+      printScope(os, regions[i], sep, indentLv + 2);
+      os << '\n' << regionIndent << "}" << (i + 1 == regions.size() ? "\n" : ",\n");
+    }
+    os << indent << "}";
+  }
+
   void JsonPrinter::printFunctions(std::ostream& os, const std::set<Function*>& funcs, int indentLv) {
     std::string&& indent = getIndent(indentLv);
     os << indent << "'functions': {";
@@ -443,12 +816,39 @@ namespace LE {
     }
   }
 
+  void JsonPrinter::printFunctions(std::ostream& os, const std::vector<std::string>& funcs, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'functions': {";
+    auto it = funcs.begin(), ie = funcs.end();
+    if (it == ie) {
+      os << "}";
+    } else {
+      os << '\n';
+      while (it != ie) {
+        os << *(it++);
+        os << (it == ie ? "\n" : ",\n");
+      }
+      os << indent << "}";
+    }
+  }
+
   void JsonPrinter::printProgramName(std::ostream& os, const std::string& name, int indentLv) {
     std::string&& indent = getIndent(indentLv);
     os << indent << "'program_name': '" << name << "'";
   }
 
   void JsonPrinter::printProgram(std::ostream& os, Program* program, int indentLv) {
+    std::vector<std::string> functions;
+    for (Function* func : program->getFunctions()) {
+      std::ostringstream oss;
+      printFunction(oss, func, indentLv + getFunctionIndent());
+      functions.push_back(oss.str());
+    }
+    printProgram(os, program, functions, indentLv);
+  }
+
+  void JsonPrinter::printProgram(std::ostream& os, Program* program,
+                                 const std::vector<std::string>& functions, int indentLv) {
     std::string&& indent = getIndent(indentLv);
 
     os << indent << "{\n";
@@ -456,12 +856,16 @@ namespace LE {
     printProgramName(os, program->getName(), indentLv + 1);
     os << ",\n";
 
-    printVarDecl(os, program->getVariableTable(), indentLv + 1);
-    os << ",\n";
-    printVarInit(os, program->getVariableTable(), indentLv + 1);
-    os << ",\n";
+    if (hasSection("variables")) {
+      printVarDecl(os, program->getVariableTable(), indentLv + 1);
+      os << ",\n";
+    }
+    if (hasSection("initialize")) {
+      printVarInit(os, program->getVariableTable(), indentLv + 1);
+      os << ",\n";
+    }
 
-    printFunctions(os, program->getFunctions(), indentLv + 1);
+    printFunctions(os, functions, indentLv + 1);
     os << "\n";
 
     os << indent << "}\n";
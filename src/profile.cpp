@@ -0,0 +1,147 @@
+#include "profile.h"
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace LE {
+
+  namespace {
+
+    // a word of a line and where it starts
+    struct Word {
+      std::string text;
+      std::string::size_type pos;
+    };
+
+    std::vector<Word> split(const std::string& line) {
+      std::vector<Word> words;
+      std::string::size_type i = 0, n = line.length();
+      while (i < n) {
+        while (i < n && isspace(line[i])) ++i;
+        if (i == n) break;
+
+        Word word;
+        word.pos = i;
+        while (i < n && !isspace(line[i])) ++i;
+        word.text = line.substr(word.pos, i - word.pos);
+        words.push_back(word);
+      }
+      return words;
+    }
+
+    bool toNumber(const std::string& text, double& value) {
+      char* end = nullptr;
+      value = std::strtod(text.c_str(), &end);
+      return !text.empty() && *end == '\0';
+    }
+
+    std::string trim(const std::string& str) {
+      std::string::size_type begin = 0, end = str.length();
+      while (begin < end && isspace(str[begin])) ++begin;
+      while (end > begin && isspace(str[end - 1])) --end;
+      return str.substr(begin, end - begin);
+    }
+
+  }
+
+  std::string Profile::normalize(const std::string& symbol) {
+    std::string name = trim(symbol);
+
+    // 'f [clone .constprop.0]', 'f(int)'
+    std::string::size_type end = name.find(" [clone");
+    if (end != std::string::npos) name = name.substr(0, end);
+    end = name.find('(');
+    if (end != std::string::npos) name = name.substr(0, end);
+
+    // 'ns::C::f'
+    std::string::size_type colon = name.rfind("::");
+    if (colon != std::string::npos) name = name.substr(colon + 2);
+
+    // 'f.constprop.0', 'f.isra.0', 'f.part.1'
+    end = name.find('.');
+    if (end != std::string::npos && end > 0) name = name.substr(0, end);
+
+    return trim(name);
+  }
+
+  void Profile::readPerf(std::istream& is) {
+    std::string line;
+    while (std::getline(is, line)) {
+      std::vector<Word>&& words = split(line);
+      if (words.empty() || words[0].text[0] == '#') continue;
+
+      // with --children the columns are 'Children Self'
+      double percent = -1;
+      for (const Word& word : words) {
+        const std::string& text = word.text;
+        double value;
+        if (text.length() < 2 || text.back() != '%' ||
+            !toNumber(text.substr(0, text.length() - 1), value)) {
+          break;
+        }
+        percent = value;
+      }
+      if (percent < 0) continue;
+
+      // symbol follows '[.]' for user space or '[k]' for kernel
+      std::string::size_type mark = line.find("[.] ");
+      if (mark == std::string::npos) mark = line.find("[k] ");
+      if (mark == std::string::npos) continue;
+
+      std::string&& name = normalize(line.substr(mark + 4));
+      if (!name.empty()) weights[name] += percent;
+    }
+  }
+
+  void Profile::readGprof(std::istream& is) {
+    std::string line;
+    bool inTable = false;
+    while (std::getline(is, line)) {
+      if (!inTable) {
+        // header of columns, e.g. ' time   seconds   seconds    calls ...'
+        inTable = line.find("seconds") != std::string::npos &&
+                  line.find("name") != std::string::npos;
+        continue;
+      }
+
+      std::vector<Word>&& words = split(line);
+      if (words.empty() || line.compare(0, 10, "Call graph") == 0) break;
+
+      // '% time', 'cumulative seconds', 'self seconds', then optionally
+      // 'calls', 'self ms/call', 'total ms/call', and the name
+      double percent, value;
+      if (words.size() < 4 || !toNumber(words[0].text, percent)) break;
+
+      size_t i = 1;
+      while (i < words.size() - 1 && i < 6 && toNumber(words[i].text, value)) ++i;
+
+      std::string&& name = normalize(line.substr(words[i].pos));
+      if (!name.empty()) weights[name] += percent;
+    }
+  }
+
+  bool Profile::load(const std::string& file) {
+    std::ifstream ifs(file);
+    if (!ifs) return false;
+
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    const std::string& text = ss.str();
+
+    std::istringstream is(text);
+    if (text.find("Flat profile") != std::string::npos) {
+      readGprof(is);
+    } else {
+      readPerf(is);
+    }
+    return true;
+  }
+
+  double Profile::getWeight(SgFunctionDeclaration* funcDecl) const {
+    auto iter = weights.find(funcDecl->get_name().getString());
+    return iter == weights.end() ? 0 : iter->second;
+  }
+
+}
@@ -7,6 +7,7 @@ namespace LE {
 
   Loop* Loop::cloneWithoutBreak() const {
     Loop* newLoop = new Loop(name, varTbl);
+    newLoop->stmt = stmt;
     for (auto p : paths) {
       if (!p->canBreakLoop()) {
         newLoop->paths.insert(p->clone());
@@ -25,9 +26,23 @@ namespace LE {
     innerLoops.insert(loop->innerLoops.begin(),
       loop->innerLoops.end());
 
+    // paths and inner loops are moved, the variable table is shared
+    loop->paths.clear();
+    loop->innerLoops.clear();
+    loop->varTbl = nullptr;
     delete loop;
   }
 
+  Loop::~Loop() {
+    for (LoopPath* path : paths) {
+      delete path;
+    }
+    for (Loop* inner : innerLoops) {
+      delete inner;
+    }
+    delete varTbl;
+  }
+
   void Loop::addInnerLoop(Loop* loop) {
     innerLoops.insert(loop);
     const std::string& name = loop->getName();
@@ -46,9 +61,44 @@ namespace LE {
   VariableTable* VariableTable::clone() const {
     VariableTable* result = new VariableTable;
     result->table.insert(table.begin(), table.end());
+    for (auto& entry : table) {
+      ++entry.second->refs;
+    }
     return result;
   }
 
+  void VariableTable::release(Variable* var) {
+    if (--var->refs == 0) {
+      delete var;
+    }
+  }
+
+  void VariableTable::addVariable(const std::string &name, Variable* var) {
+    ++var->refs;
+    auto iter = table.find(name);
+    if (iter == table.end()) {
+      table[name] = var;
+      return;
+    }
+    Variable* old = iter->second;
+    iter->second = var;
+    release(old);
+  }
+
+  void VariableTable::removeVariable(const std::string &name) {
+    auto iter = table.find(name);
+    if (iter == table.end()) return;
+    Variable* var = iter->second;
+    table.erase(iter);
+    release(var);
+  }
+
+  VariableTable::~VariableTable() {
+    for (auto& entry : table) {
+      release(entry.second);
+    }
+  }
+
   Path* Path::clone() {
     ConstraintList* cl = constraintList->clone();
     std::string&& pathName = PathNameAllocator::allocName();
@@ -77,7 +127,65 @@ namespace LE {
       loops.insert(l);
     }
 
+    // paths, blocks and loops are moved, the variable table is shared
+    func->paths.clear();
+    func->blocks.clear();
+    func->loops.clear();
+    func->varTbl = nullptr;
     delete func;
   }
 
+  std::set<std::string> Function::getUpdated() {
+    std::set<std::string> updated;
+    std::vector<Loop*> stack;
+    for (Function* scope : getScopes()) {
+      for (Block* block : scope->blocks) {
+        VariableTable* blockTbl = block->getVariableTable();
+        for (auto it = blockTbl->begin(), ie = blockTbl->end(); it != ie; ++it) {
+          updated.insert(ASTHelper::getBaseName(it->first));
+        }
+      }
+      stack.insert(stack.end(), scope->loops.begin(), scope->loops.end());
+    }
+
+    std::set<Loop*> visited;
+    while (!stack.empty()) {
+      Loop* loop = stack.back();
+      stack.pop_back();
+      if (!visited.insert(loop).second) continue;
+      for (LoopPath* path : *loop) {
+        VariableTable* pathTbl = path->getVariableTable();
+        for (auto it = pathTbl->begin(), ie = pathTbl->end(); it != ie; ++it) {
+          updated.insert(ASTHelper::getBaseName(it->first));
+        }
+      }
+      stack.insert(stack.end(), loop->getInnerLoops().begin(), loop->getInnerLoops().end());
+    }
+    return updated;
+  }
+
+  Function::~Function() {
+    for (Path* p : paths) {
+      delete p;
+    }
+    for (Loop* l : loops) {
+      delete l;
+    }
+    for (Block* b : blocks) {
+      delete b;
+    }
+    for (Function* region : regions) {
+      region->varTbl = nullptr;
+      delete region;
+    }
+    delete varTbl;
+  }
+
+  Program::~Program() {
+    for (Function* func : globalFuncs) {
+      delete func;
+    }
+    delete varTbl;
+  }
+
 }
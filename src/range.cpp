@@ -0,0 +1,643 @@
+#include "range.h"
+#include "astHelper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <limits>
+
+namespace LE {
+
+  const int RangeAnalysis::widenDelay;
+
+  static const double inf = std::numeric_limits<double>::infinity();
+
+  // values of a parameter of a type, before any constraint
+  static Interval typeRange(VariantT type) {
+    switch (type) {
+      case T_BOOL: return { 0, 1 };
+      case T_CHAR: case T_SIGNED_CHAR: return { -128, 127 };
+      case T_UNSIGNED_CHAR: return { 0, 255 };
+      case T_SHORT: case T_SIGNED_SHORT: return { -32768, 32767 };
+      case T_UNSIGNED_SHORT: return { 0, 65535 };
+      case T_UNSIGNED_INT: case T_UNSIGNED_LONG: case T_UNSIGNED_LONG_LONG: return { 0, inf };
+      default: return { -inf, inf };
+    }
+  }
+
+  // 'b op a' for 'a op b'
+  static VariantT mirror(VariantT op) {
+    switch (op) {
+      case V_SgLessThanOp: return V_SgGreaterThanOp;
+      case V_SgGreaterThanOp: return V_SgLessThanOp;
+      case V_SgLessOrEqualOp: return V_SgGreaterOrEqualOp;
+      case V_SgGreaterOrEqualOp: return V_SgLessOrEqualOp;
+      default: return op;
+    }
+  }
+
+  // the comparison that holds when one doesn't, e.g. '>=' for '<'
+  static VariantT negate(VariantT op) {
+    switch (op) {
+      case V_SgLessThanOp: return V_SgGreaterOrEqualOp;
+      case V_SgGreaterThanOp: return V_SgLessOrEqualOp;
+      case V_SgLessOrEqualOp: return V_SgGreaterThanOp;
+      case V_SgGreaterOrEqualOp: return V_SgLessThanOp;
+      case V_SgEqualityOp: return V_SgNotEqualOp;
+      default: return V_SgEqualityOp;
+    }
+  }
+
+  static bool isComparison(VariantT op) {
+    return op == V_SgLessThanOp || op == V_SgGreaterThanOp || op == V_SgLessOrEqualOp ||
+           op == V_SgGreaterOrEqualOp || op == V_SgEqualityOp || op == V_SgNotEqualOp;
+  }
+
+  // a bound of 0 times an infinite bound is 0, as the values are finite
+  static double multiply(double a, double b) {
+    return (a == 0 || b == 0) ? 0 : a * b;
+  }
+
+  // a NaN bound, e.g. of inf - inf, is unbounded
+  static Interval bounds(double lo, double hi) {
+    return { std::isnan(lo) ? -inf : lo, std::isnan(hi) ? inf : hi };
+  }
+
+  // smallest interval of four corners, unbounded if one is NaN
+  static Interval corners(double a, double b, double c, double d) {
+    if (std::isnan(a) || std::isnan(b) || std::isnan(c) || std::isnan(d)) {
+      return { -inf, inf };
+    }
+    return { std::min(std::min(a, b), std::min(c, d)), std::max(std::max(a, b), std::max(c, d)) };
+  }
+
+  static Interval truncate(const Interval& range) {
+    return { std::trunc(range.lo), std::trunc(range.hi) };
+  }
+
+  // [0, 1] if a value may be true and false, [1, 1] if always true, ...
+  static Interval truth(bool mayBeTrue, bool mayBeFalse) {
+    return { mayBeFalse ? 0.0 : 1.0, mayBeTrue ? 1.0 : 0.0 };
+  }
+
+  static bool mayBeZero(const Interval& range) {
+    return range.lo <= 0 && range.hi >= 0;
+  }
+
+  static bool isZero(const Interval& range) {
+    return range.lo == 0 && range.hi == 0;
+  }
+
+  Interval RangeAnalysis::top() {
+    return { -inf, inf };
+  }
+
+  bool RangeAnalysis::isTop(const Interval& range) {
+    return range.lo == -inf && range.hi == inf;
+  }
+
+  Interval RangeAnalysis::hull(const Interval& a, const Interval& b) {
+    return { std::min(a.lo, b.lo), std::max(a.hi, b.hi) };
+  }
+
+  RangeAnalysis::State RangeAnalysis::join(const State& a, const State& b) {
+    if (!a.reachable) return b;
+    if (!b.reachable) return a;
+
+    // a variable unbounded in either state is unbounded in the join
+    State result;
+    for (auto& var : a.vars) {
+      auto other = b.vars.find(var.first);
+      if (other != b.vars.end()) {
+        result.vars[var.first] = hull(var.second, other->second);
+      }
+    }
+    return result;
+  }
+
+  RangeAnalysis::State RangeAnalysis::widen(const State& before, const State& after) {
+    if (!before.reachable) return after;
+    if (!after.reachable) return before;
+
+    State result;
+    for (auto& var : before.vars) {
+      auto other = after.vars.find(var.first);
+      if (other == after.vars.end()) continue;
+
+      Interval range = var.second;
+      if (other->second.lo < range.lo) range.lo = -inf;
+      if (other->second.hi > range.hi) range.hi = inf;
+      if (!isTop(range)) {
+        result.vars[var.first] = range;
+      }
+    }
+    return result;
+  }
+
+  bool RangeAnalysis::same(const State& a, const State& b) {
+    if (a.reachable != b.reachable || a.vars.size() != b.vars.size()) return false;
+    for (auto ia = a.vars.begin(), ib = b.vars.begin(); ia != a.vars.end(); ++ia, ++ib) {
+      if (ia->first != ib->first || ia->second.lo != ib->second.lo ||
+          ia->second.hi != ib->second.hi) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::map<std::string, Interval> RangeAnalysis::bounded(const State& state) {
+    std::map<std::string, Interval> ranges;
+    for (auto& var : state.vars) {
+      if (!isTop(var.second)) {
+        ranges.insert(var);
+      }
+    }
+    return ranges;
+  }
+
+  void RangeAnalysis::assign(State& state, const std::string& name, Interval range) {
+    if (std::isnan(range.lo)) range.lo = -inf;
+    if (std::isnan(range.hi)) range.hi = inf;
+    if (integral.count(name) > 0) {
+      range = truncate(range);
+    }
+
+    if (isTop(range)) {
+      state.vars.erase(name);
+    } else {
+      state.vars[name] = range;
+    }
+  }
+
+  void RangeAnalysis::narrow(State& state, const std::string& name, double lo, double hi) {
+    if (!state.reachable) return;
+
+    auto iter = state.vars.find(name);
+    Interval range = iter == state.vars.end() ? top() : iter->second;
+    range.lo = std::max(range.lo, lo);
+    range.hi = std::min(range.hi, hi);
+    if (integral.count(name) > 0) {
+      range.lo = std::ceil(range.lo);
+      range.hi = std::floor(range.hi);
+    }
+
+    if (!(range.lo <= range.hi)) {
+      state.reachable = false;
+      state.vars.clear();
+    } else if (!isTop(range)) {
+      state.vars[name] = range;
+    }
+  }
+
+  bool RangeAnalysis::mayHold(VariantT op, const Interval& lhs, const Interval& rhs) {
+    switch (op) {
+      case V_SgLessThanOp: return lhs.lo < rhs.hi;
+      case V_SgGreaterThanOp: return lhs.hi > rhs.lo;
+      case V_SgLessOrEqualOp: return lhs.lo <= rhs.hi;
+      case V_SgGreaterOrEqualOp: return lhs.hi >= rhs.lo;
+      case V_SgEqualityOp: return lhs.lo <= rhs.hi && rhs.lo <= lhs.hi;
+      default:
+        return !(lhs.lo == lhs.hi && rhs.lo == rhs.hi && lhs.lo == rhs.lo);
+    }
+  }
+
+  Interval RangeAnalysis::applyBinary(SgBinaryOp* binOp, const Interval& lhs,
+                                      const Interval& rhs) {
+    VariantT op = binOp->variantT();
+    if (isComparison(op)) {
+      return truth(mayHold(op, lhs, rhs), mayHold(negate(op), lhs, rhs));
+    }
+
+    switch (op) {
+      case V_SgAddOp:
+        return bounds(lhs.lo + rhs.lo, lhs.hi + rhs.hi);
+      case V_SgSubtractOp:
+        return bounds(lhs.lo - rhs.hi, lhs.hi - rhs.lo);
+      case V_SgMultiplyOp:
+        return corners(multiply(lhs.lo, rhs.lo), multiply(lhs.lo, rhs.hi),
+                       multiply(lhs.hi, rhs.lo), multiply(lhs.hi, rhs.hi));
+      case V_SgDivideOp:
+      case V_SgIntegerDivideOp: {
+        if (mayBeZero(rhs)) return top();
+        Interval range = corners(lhs.lo / rhs.lo, lhs.lo / rhs.hi, lhs.hi / rhs.lo, lhs.hi / rhs.hi);
+        bool isInt = op == V_SgIntegerDivideOp || ASTHelper::isIntegralType(binOp->get_type());
+        return isInt ? truncate(range) : range;
+      }
+      case V_SgModOp: {
+        // the remainder is smaller than the divisor and has the sign of the dividend
+        double m = std::max(std::fabs(rhs.lo), std::fabs(rhs.hi)) - 1;
+        if (m < 0) return top();
+        if (lhs.lo >= 0) return { 0, std::min(lhs.hi, m) };
+        if (lhs.hi <= 0) return { std::max(lhs.lo, -m), 0 };
+        return { -m, m };
+      }
+      case V_SgAndOp:
+        return truth(!isZero(lhs) && !isZero(rhs), mayBeZero(lhs) || mayBeZero(rhs));
+      case V_SgOrOp:
+        return truth(!isZero(lhs) || !isZero(rhs), mayBeZero(lhs) && mayBeZero(rhs));
+      case V_SgBitAndOp:
+        if (lhs.lo >= 0 || rhs.lo >= 0) {
+          double hi = lhs.lo < 0 ? rhs.hi : rhs.lo < 0 ? lhs.hi : std::min(lhs.hi, rhs.hi);
+          return { 0, hi };
+        }
+        return top();
+      case V_SgBitOrOp:
+      case V_SgBitXorOp:
+        if (lhs.lo >= 0 && rhs.lo >= 0) {
+          // every bit is below the highest bit of the larger operand
+          double hi = std::max(lhs.hi, rhs.hi);
+          if (hi < 1) return { 0, 0 };
+          return { 0, std::isinf(hi) ? inf : std::exp2(std::floor(std::log2(hi)) + 1) - 1 };
+        }
+        return top();
+      case V_SgLshiftOp:
+        if (lhs.lo >= 0 && rhs.lo >= 0) {
+          return { multiply(lhs.lo, std::exp2(rhs.lo)), multiply(lhs.hi, std::exp2(rhs.hi)) };
+        }
+        return top();
+      case V_SgRshiftOp:
+        if (lhs.lo >= 0 && rhs.lo >= 0) {
+          return { std::floor(lhs.lo / std::exp2(rhs.hi)), std::floor(lhs.hi / std::exp2(rhs.lo)) };
+        }
+        return top();
+      case V_SgCommaOpExp:
+        return rhs;
+      default:
+        return top();
+    }
+  }
+
+  Interval RangeAnalysis::applyUnary(SgUnaryOp* unaryOp, const Interval& operand) {
+    switch (unaryOp->variantT()) {
+      case V_SgPlusPlusOp: return { operand.lo + 1, operand.hi + 1 };
+      case V_SgMinusMinusOp: return { operand.lo - 1, operand.hi - 1 };
+      case V_SgNotOp: return truth(mayBeZero(operand), !isZero(operand));
+      case V_SgMinusOp: return { -operand.hi, -operand.lo };
+      case V_SgBitComplementOp: return { -operand.hi - 1, -operand.lo - 1 };
+      case V_SgUnaryAddOp: return operand;
+      case V_SgCastExp:
+        return ASTHelper::isIntegralType(unaryOp->get_type()) ? truncate(operand) : operand;
+      default:
+        return top();
+    }
+  }
+
+  Interval RangeAnalysis::evaluate(SgExpression* expr, const State& state) {
+    // expressions left to evaluate under the ranges of their branch, and
+    // operators left to apply to the values of their operands, the next
+    // one last, in place of recursion over deeply nested expressions
+    struct Step {
+      SgExpression* expr;
+      const State* state;
+      bool apply;
+    };
+    std::vector<Step> steps(1, Step{expr, &state, false});
+    std::vector<Interval> values;
+    // ranges of the branches of conditional expressions
+    std::deque<State> branches;
+
+    while (!steps.empty()) {
+      Step step = steps.back();
+      steps.pop_back();
+      SgExpression* expr = step.expr;
+
+      if (step.apply) {
+        Interval last = values.back();
+        values.pop_back();
+        if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+          values.back() = applyBinary(binOp, values.back(), last);
+        } else if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(expr)) {
+          values.push_back(applyUnary(unaryOp, last));
+        } else {
+          values.back() = hull(values.back(), last);
+        }
+        continue;
+      }
+
+      const State& state = *step.state;
+      if (expr == nullptr) {
+        values.push_back(top());
+      } else if (SgBoolValExp* boolVal = dynamic_cast<SgBoolValExp*>(expr)) {
+        double v = boolVal->get_value() ? 1 : 0;
+        values.push_back({ v, v });
+      } else if (SgValueExp* value = dynamic_cast<SgValueExp*>(expr)) {
+        std::string&& str = value->get_constant_folded_value_as_string();
+        char* end = nullptr;
+        double v = std::strtod(str.c_str(), &end);
+        if (str.empty() || *end != '\0' || std::isnan(v)) {
+          values.push_back(top());
+        } else {
+          values.push_back({ v, v });
+        }
+      } else if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr)) {
+        auto iter = state.vars.find(var->get_symbol()->get_name().getString());
+        values.push_back(iter == state.vars.end() ? top() : iter->second);
+      } else if (SgAssignInitializer* initializer = dynamic_cast<SgAssignInitializer*>(expr)) {
+        steps.push_back(Step{initializer->get_operand(), &state, false});
+      } else if (SgConditionalExp* condExp = dynamic_cast<SgConditionalExp*>(expr)) {
+        // each branch is evaluated under the ranges for which it is taken
+        branches.push_back(refine(state, condExp->get_conditional_exp(), true));
+        const State& whenTrue = branches.back();
+        branches.push_back(refine(state, condExp->get_conditional_exp(), false));
+        const State& whenFalse = branches.back();
+        if (!whenTrue.reachable && !whenFalse.reachable) {
+          values.push_back(top());
+        } else if (!whenFalse.reachable) {
+          steps.push_back(Step{condExp->get_true_exp(), &whenTrue, false});
+        } else if (!whenTrue.reachable) {
+          steps.push_back(Step{condExp->get_false_exp(), &whenFalse, false});
+        } else {
+          steps.push_back(Step{condExp, nullptr, true});
+          steps.push_back(Step{condExp->get_false_exp(), &whenFalse, false});
+          steps.push_back(Step{condExp->get_true_exp(), &whenTrue, false});
+        }
+      } else if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+        steps.push_back(Step{binOp, nullptr, true});
+        steps.push_back(Step{binOp->get_rhs_operand(), &state, false});
+        steps.push_back(Step{binOp->get_lhs_operand(), &state, false});
+      } else if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(expr)) {
+        steps.push_back(Step{unaryOp, nullptr, true});
+        steps.push_back(Step{unaryOp->get_operand(), &state, false});
+      } else {
+        values.push_back(top());
+      }
+    }
+    return values.back();
+  }
+
+  RangeAnalysis::State RangeAnalysis::refine(const State& state, SgExpression* constraint,
+                                             bool holds) {
+    if (!state.reachable || constraint == nullptr) return state;
+
+    if (SgNotOp* notOp = dynamic_cast<SgNotOp*>(constraint)) {
+      return refine(state, notOp->get_operand(), !holds);
+    }
+
+    SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(constraint);
+    VariantT op = binOp == nullptr ? V_SgNode : binOp->variantT();
+
+    // 'a && b' holds if both hold, '!(a || b)' if neither does
+    if ((op == V_SgAndOp && holds) || (op == V_SgOrOp && !holds)) {
+      return refine(refine(state, binOp->get_lhs_operand(), holds), binOp->get_rhs_operand(), holds);
+    }
+    if (op == V_SgAndOp || op == V_SgOrOp) {
+      return join(refine(state, binOp->get_lhs_operand(), holds),
+                  refine(state, binOp->get_rhs_operand(), holds));
+    }
+
+    State result = state;
+    if (isComparison(op)) {
+      if (!holds) op = negate(op);
+      Interval lhs = evaluate(binOp->get_lhs_operand(), state);
+      Interval rhs = evaluate(binOp->get_rhs_operand(), state);
+      if (!mayHold(op, lhs, rhs)) return State(false);
+
+      // a variable compared with an expression is bounded by its range
+      SgVarRefExp* vars[2] = { dynamic_cast<SgVarRefExp*>(binOp->get_lhs_operand()),
+                               dynamic_cast<SgVarRefExp*>(binOp->get_rhs_operand()) };
+      Interval others[2] = { rhs, lhs };
+      VariantT ops[2] = { op, mirror(op) };
+      for (int k = 0; k < 2; ++k) {
+        if (vars[k] == nullptr) continue;
+        const std::string& name = vars[k]->get_symbol()->get_name().getString();
+        const Interval& other = others[k];
+        bool isInt = integral.count(name) > 0;
+        switch (ops[k]) {
+          case V_SgLessThanOp:
+            narrow(result, name, -inf, isInt ? std::ceil(other.hi) - 1 : other.hi);
+            break;
+          case V_SgLessOrEqualOp:
+            narrow(result, name, -inf, other.hi);
+            break;
+          case V_SgGreaterThanOp:
+            narrow(result, name, isInt ? std::floor(other.lo) + 1 : other.lo, inf);
+            break;
+          case V_SgGreaterOrEqualOp:
+            narrow(result, name, other.lo, inf);
+            break;
+          case V_SgEqualityOp:
+            narrow(result, name, other.lo, other.hi);
+            break;
+          default: {
+            // 'x != c' only cuts c off a bound of x
+            Interval range = evaluate(vars[k], result);
+            if (isInt && other.lo == other.hi && range.lo == other.lo) {
+              narrow(result, name, other.lo + 1, inf);
+            } else if (isInt && other.lo == other.hi && range.hi == other.hi) {
+              narrow(result, name, -inf, other.hi - 1);
+            }
+          }
+        }
+      }
+      return result;
+    }
+
+    // any other constraint holds if its value is not 0
+    Interval value = evaluate(constraint, state);
+    if (holds ? isZero(value) : !mayBeZero(value)) return State(false);
+    if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(constraint)) {
+      const std::string& name = var->get_symbol()->get_name().getString();
+      if (!holds) {
+        narrow(result, name, 0, 0);
+      } else if (value.lo == 0) {
+        narrow(result, name, integral.count(name) > 0 ? 1 : 0, inf);
+      } else if (value.hi == 0) {
+        narrow(result, name, -inf, integral.count(name) > 0 ? -1 : 0);
+      }
+    }
+    return result;
+  }
+
+  RangeAnalysis::State RangeAnalysis::apply(const State& state, VariableTable* varTbl) {
+    if (!state.reachable) return state;
+
+    // values are in terms of the ranges before the updates
+    State result = state;
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      // arrays don't alias variables, pointers may point to any
+      if (!ASTHelper::isPlainName(it->first) && it->first.find('[') == std::string::npos) {
+        result.vars.clear();
+      }
+    }
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      if (ASTHelper::isPlainName(it->first)) {
+        assign(result, it->first, evaluate(it->second->getValue(), state));
+      }
+    }
+    return result;
+  }
+
+  void RangeAnalysis::iterate(Loop* loop, const State& header, State& back, State& exit,
+                              bool record) {
+    back = exit = State(false);
+
+    std::map<std::string, Loop*> innerLoops;
+    for (Loop* inner : loop->getInnerLoops()) {
+      innerLoops[inner->getName()] = inner;
+    }
+
+    for (LoopPath* path : *loop) {
+      State state = header;
+      for (SgExpression* constraint : *path->getConstraintList()) {
+        state = refine(state, constraint, true);
+      }
+      state = apply(state, path->getVariableTable());
+      for (const std::string& name : path->getInnerLoops()) {
+        auto inner = innerLoops.find(name);
+        if (inner != innerLoops.end()) {
+          state = analyzeLoop(inner->second, state, record);
+        }
+      }
+
+      if (path->canBreakLoop()) {
+        exit = join(exit, state);
+      } else {
+        back = join(back, state);
+      }
+    }
+  }
+
+  Interval RangeAnalysis::initialRange(Variable* var, const State& state) {
+    std::set<std::string> reads;
+    ASTHelper::collectVarNames(var->getInitValue(), reads);
+    for (const std::string& read : reads) {
+      if (updated.count(read) > 0) return top();
+    }
+    return evaluate(var->getInitValue(), state);
+  }
+
+  RangeAnalysis::State RangeAnalysis::analyzeLoop(Loop* loop, const State& entry, bool record) {
+    if (!entry.reachable) return entry;
+
+    // variables declared in the loop are initialized on entry
+    State start = entry;
+    VariableTable* decls = loop->getVariableTable();
+    for (auto it = decls->begin(), ie = decls->end(); it != ie; ++it) {
+      assign(start, it->first, initialRange(it->second, start));
+    }
+
+    // ascending iterations, inner loops don't record their headers
+    // until the ranges of this one are final
+    State header = start, back, exit;
+    for (int iter = 0; ; ++iter) {
+      iterate(loop, header, back, exit, false);
+      State next = join(start, back);
+      if (iter >= widenDelay) {
+        next = widen(header, next);
+      }
+      if (same(next, header)) break;
+      header = next;
+    }
+
+    // one descending iteration bounds what widening made infinite,
+    // its result still holds at every iteration
+    iterate(loop, header, back, exit, false);
+    header = join(start, back);
+
+    iterate(loop, header, back, exit, record);
+    if (record) {
+      auto iter = headers.find(loop);
+      headers[loop] = iter == headers.end() ? header : join(iter->second, header);
+    }
+    return exit;
+  }
+
+  void RangeAnalysis::collectIntegral(VariableTable* varTbl) {
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      if (ASTHelper::isIntegralType(it->second->getType())) {
+        integral.insert(it->first);
+      }
+    }
+  }
+
+  void RangeAnalysis::analyze(Function* func) {
+    RangeAnalysis analysis;
+
+    std::vector<Function*>&& scopes = func->getScopes();
+
+    std::map<std::string, Block*> blocks;
+    std::map<std::string, Loop*> loops;
+    std::vector<Loop*> stack;
+    for (Function* scope : scopes) {
+      for (Block* block : scope->getBlocks()) {
+        blocks[block->getName()] = block;
+      }
+      for (Loop* loop : scope->getLoops()) {
+        loops[loop->getName()] = loop;
+        stack.push_back(loop);
+      }
+    }
+
+    VariableTable* varTbl = func->getVariableTable();
+    analysis.collectIntegral(varTbl);
+    std::set<Loop*> visited;
+    while (!stack.empty()) {
+      Loop* loop = stack.back();
+      stack.pop_back();
+      if (!visited.insert(loop).second) continue;
+      analysis.collectIntegral(loop->getVariableTable());
+      stack.insert(stack.end(), loop->getInnerLoops().begin(), loop->getInnerLoops().end());
+    }
+
+    // parameters range over their type, declared variables
+    // over their initial value
+    State entry;
+    std::set<std::string> params = func->getParams();
+    for (const std::string& param : params) {
+      Variable* var = varTbl->getVariable(param);
+      if (var != nullptr) {
+        analysis.assign(entry, param, typeRange(var->getType()));
+      }
+    }
+    analysis.updated = func->getUpdated();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      if (params.count(it->first) == 0) {
+        analysis.assign(entry, it->first, analysis.initialRange(it->second, entry));
+      }
+    }
+
+    // a region starts where paths of the one before don't return
+    for (Function* scope : scopes) {
+      State next(false);
+      for (Path* path : scope->getPaths()) {
+        // each constraint narrows the ranges after the steps before it
+        State state = entry;
+        ConstraintList* cl = path->getConstraints();
+        const std::vector<std::string>& elements = path->getPaths();
+        size_t c = 0;
+        for (size_t step = 0; ; ++step) {
+          for (; c < cl->size() && cl->getStep(c) <= step; ++c) {
+            state = analysis.refine(state, cl->get(c), true);
+          }
+          if (step == elements.size()) break;
+
+          auto block = blocks.find(elements[step]);
+          auto loop = loops.find(elements[step]);
+          if (block != blocks.end()) {
+            state = analysis.apply(state, block->second->getVariableTable());
+          } else if (loop != loops.end()) {
+            state = analysis.analyzeLoop(loop->second, state, true);
+          }
+        }
+
+        if (state.reachable) {
+          path->setRanges(bounded(state));
+        } else {
+          path->setInfeasible();
+        }
+        if (!path->isPathReturn()) {
+          next = join(next, state);
+        }
+      }
+      entry = next;
+    }
+
+    for (Loop* loop : visited) {
+      auto iter = analysis.headers.find(loop);
+      loop->setRanges(iter == analysis.headers.end() ? std::map<std::string, Interval>()
+                                                     : bounded(iter->second));
+    }
+  }
+
+}
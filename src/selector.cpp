@@ -0,0 +1,51 @@
+#include "selector.h"
+#include "message.h"
+#include <fnmatch.h>
+
+namespace LE {
+
+  std::vector<Selector::Pattern> Selector::compile(const std::vector<std::string>& patterns) {
+    std::vector<Pattern> result;
+    for (const std::string& str : patterns) {
+      Pattern pattern;
+      pattern.isRegex = str.length() >= 2 && str.front() == '/' && str.back() == '/';
+      if (pattern.isRegex) {
+        try {
+          pattern.regex = std::regex(str.substr(1, str.length() - 2));
+        } catch (const std::regex_error& e) {
+          Message::error("invalid regular expression " + str + ": " + e.what());
+        }
+      } else {
+        pattern.glob = str;
+      }
+      result.push_back(pattern);
+    }
+    return result;
+  }
+
+  bool Selector::matches(const std::vector<Pattern>& patterns, const std::string& name) {
+    if (patterns.empty()) return true;
+
+    for (const Pattern& pattern : patterns) {
+      if (pattern.isRegex ? std::regex_search(name, pattern.regex)
+                          : fnmatch(pattern.glob.c_str(), name.c_str(), 0) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  Selector::Selector(const Options& options):
+    functions(compile(options.functions)), files(compile(options.files)) {}
+
+  bool Selector::selectsFunction(const std::string& name) const {
+    return matches(functions, name);
+  }
+
+  bool Selector::selectsFile(const std::string& path) const {
+    std::string::size_type slash = path.rfind('/');
+    return matches(files, path) ||
+           (slash != std::string::npos && matches(files, path.substr(slash + 1)));
+  }
+
+}
@@ -0,0 +1,582 @@
+#include "smtPrinter.h"
+#include "astHelper.h"
+#include "message.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace LE {
+
+  SmtPrinter::SmtPrinter(VariableTable* globals) {
+    if (globals != nullptr) setGlobals(globals);
+  }
+
+  void SmtPrinter::setGlobals(VariableTable* varTbl) {
+    globals.clear();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      globals[it->first] = toSort(it->second->getType());
+    }
+  }
+
+  SmtPrinter::Sort SmtPrinter::toSort(VariantT type) {
+    switch (type) {
+      case T_FLOAT:
+      case T_DOUBLE:
+      case T_LONG_DOUBLE:
+        return SORT_REAL;
+      case T_BOOL:
+        return SORT_BOOL;
+      default:
+        // integers, chars, and pointers compared against null
+        return SORT_INT;
+    }
+  }
+
+  std::string SmtPrinter::sortName(Sort sort) {
+    switch (sort) {
+      case SORT_REAL: return "Real";
+      case SORT_BOOL: return "Bool";
+      default: return "Int";
+    }
+  }
+
+  // quoted symbols never clash with reserved words like div or abs
+  std::string SmtPrinter::quote(const std::string& name) {
+    return "|" + name + "|";
+  }
+
+  std::string SmtPrinter::toBool(const Term& term) {
+    switch (term.sort) {
+      case SORT_BOOL: return term.text;
+      case SORT_REAL: return "(not (= " + term.text + " 0.0))";
+      default: return "(not (= " + term.text + " 0))";
+    }
+  }
+
+  std::string SmtPrinter::toNumber(const Term& term, Sort sort) {
+    if (term.sort == SORT_BOOL) {
+      return sort == SORT_REAL ? "(ite " + term.text + " 1.0 0.0)" : "(ite " + term.text + " 1 0)";
+    }
+    if (term.sort == SORT_INT && sort == SORT_REAL) {
+      return "(to_real " + term.text + ")";
+    }
+    if (term.sort == SORT_REAL && sort == SORT_INT) {
+      // to_int rounds toward negative infinity while C truncates
+      return "(let ((x " + term.text + ")) (ite (>= x 0.0) (to_int x) (- (to_int (- x)))))";
+    }
+    return term.text;
+  }
+
+  // SMT-LIB has no negative literals and no exponent notation
+  static std::string numeral(double v, bool integral) {
+    double magnitude = v < 0 ? -v : v;
+    std::ostringstream oss;
+    std::string str;
+    if (integral) {
+      oss << static_cast<long long>(magnitude);
+      str = oss.str();
+    } else {
+      oss << std::fixed << std::setprecision(17) << magnitude;
+      str = oss.str();
+      size_t last = str.find_last_not_of('0');
+      if (str[last] == '.') ++last;
+      str.erase(last + 1);
+    }
+    return v < 0 ? "(- " + str + ")" : str;
+  }
+
+  bool SmtPrinter::translate(SgExpression* expr, Term& term) {
+    if (expr == nullptr) return false;
+
+    if (SgBoolValExp* boolVal = dynamic_cast<SgBoolValExp*>(expr)) {
+      term.text = boolVal->get_value() ? "true" : "false";
+      term.sort = SORT_BOOL;
+      return true;
+    }
+
+    if (SgValueExp* value = dynamic_cast<SgValueExp*>(expr)) {
+      std::string&& str = value->get_constant_folded_value_as_string();
+      char* end = nullptr;
+      double v = std::strtod(str.c_str(), &end);
+      if (str.empty() || *end != '\0') return false;
+      SgType* type = value->get_type();
+      term.sort = type == nullptr ? SORT_INT : toSort(type->stripTypedefsAndModifiers()->variantT());
+      if (term.sort == SORT_BOOL) term.sort = SORT_INT;
+      term.text = numeral(v, term.sort == SORT_INT);
+      return true;
+    }
+
+    if (SgVarRefExp* var = dynamic_cast<SgVarRefExp*>(expr)) {
+      std::string&& name = var->get_symbol()->get_name().getString();
+      auto it = sorts.find(name);
+      term.text = quote(name);
+      term.sort = it == sorts.end() ? SORT_INT : it->second;
+      referenced.insert(name);
+      return true;
+    }
+
+    if (SgAssignInitializer* initializer = dynamic_cast<SgAssignInitializer*>(expr)) {
+      return translate(initializer->get_operand(), term);
+    }
+
+    if (SgConditionalExp* condExp = dynamic_cast<SgConditionalExp*>(expr)) {
+      Term cond, a, b;
+      if (!translate(condExp->get_conditional_exp(), cond) ||
+          !translate(condExp->get_true_exp(), a) || !translate(condExp->get_false_exp(), b)) {
+        return false;
+      }
+      if (a.sort == SORT_BOOL && b.sort == SORT_BOOL) {
+        term.sort = SORT_BOOL;
+        term.text = "(ite " + toBool(cond) + " " + a.text + " " + b.text + ")";
+      } else {
+        term.sort = (a.sort == SORT_REAL || b.sort == SORT_REAL) ? SORT_REAL : SORT_INT;
+        term.text = "(ite " + toBool(cond) + " " + toNumber(a, term.sort) + " " +
+                    toNumber(b, term.sort) + ")";
+      }
+      return true;
+    }
+
+    if (SgBinaryOp* binOp = dynamic_cast<SgBinaryOp*>(expr)) {
+      Term lhs, rhs;
+      if (!translate(binOp->get_lhs_operand(), lhs) || !translate(binOp->get_rhs_operand(), rhs)) {
+        return false;
+      }
+
+      // operands of arithmetic and comparison share a numeric sort
+      Sort common = (lhs.sort == SORT_REAL || rhs.sort == SORT_REAL) ? SORT_REAL : SORT_INT;
+      std::string&& l = toNumber(lhs, common);
+      std::string&& r = toNumber(rhs, common);
+
+      std::string op;
+      term.sort = common;
+      switch (binOp->variantT()) {
+        case V_SgAddOp: op = "+"; break;
+        case V_SgSubtractOp: op = "-"; break;
+        case V_SgMultiplyOp: op = "*"; break;
+        case V_SgDivideOp:
+          if (common != SORT_INT) {
+            op = "/";
+            break;
+          }
+          // div and mod are euclidean, C truncates toward zero, so the
+          // quotient and remainder of |a| are negated for a negative a
+          term.text = "(let ((a " + l + ") (b " + r + ")) "
+                      "(ite (>= a 0) (div a b) (- (div (- a) b))))";
+          return true;
+        case V_SgModOp:
+          if (common != SORT_INT) return false;
+          term.text = "(let ((a " + l + ") (b " + r + ")) "
+                      "(ite (>= a 0) (mod a b) (- (mod (- a) b))))";
+          return true;
+        case V_SgLessThanOp: op = "<"; term.sort = SORT_BOOL; break;
+        case V_SgGreaterThanOp: op = ">"; term.sort = SORT_BOOL; break;
+        case V_SgLessOrEqualOp: op = "<="; term.sort = SORT_BOOL; break;
+        case V_SgGreaterOrEqualOp: op = ">="; term.sort = SORT_BOOL; break;
+        case V_SgEqualityOp:
+          term.text = "(= " + l + " " + r + ")";
+          term.sort = SORT_BOOL;
+          return true;
+        case V_SgNotEqualOp:
+          term.text = "(not (= " + l + " " + r + "))";
+          term.sort = SORT_BOOL;
+          return true;
+        case V_SgAndOp:
+          term.text = "(and " + toBool(lhs) + " " + toBool(rhs) + ")";
+          term.sort = SORT_BOOL;
+          return true;
+        case V_SgOrOp:
+          term.text = "(or " + toBool(lhs) + " " + toBool(rhs) + ")";
+          term.sort = SORT_BOOL;
+          return true;
+        default:
+          // arrays, pointers, bitwise operations
+          return false;
+      }
+      term.text = "(" + op + " " + l + " " + r + ")";
+      return true;
+    }
+
+    if (SgUnaryOp* unaryOp = dynamic_cast<SgUnaryOp*>(expr)) {
+      Term operand;
+      if (!translate(unaryOp->get_operand(), operand)) return false;
+
+      Sort numeric = operand.sort == SORT_REAL ? SORT_REAL : SORT_INT;
+      std::string&& one = numeric == SORT_REAL ? "1.0" : "1";
+      switch (unaryOp->variantT()) {
+        case V_SgNotOp:
+          term.text = "(not " + toBool(operand) + ")";
+          term.sort = SORT_BOOL;
+          return true;
+        case V_SgMinusOp:
+          term.text = "(- " + toNumber(operand, numeric) + ")";
+          break;
+        case V_SgUnaryAddOp:
+          term.text = operand.text;
+          numeric = operand.sort;
+          break;
+        case V_SgPlusPlusOp:
+          term.text = "(+ " + toNumber(operand, numeric) + " " + one + ")";
+          break;
+        case V_SgMinusMinusOp:
+          term.text = "(- " + toNumber(operand, numeric) + " " + one + ")";
+          break;
+        case V_SgCastExp: {
+          SgType* type = unaryOp->get_type();
+          numeric = type == nullptr ? operand.sort : toSort(type->stripTypedefsAndModifiers()->variantT());
+          term.text = numeric == SORT_BOOL ? toBool(operand) : toNumber(operand, numeric);
+          break;
+        }
+        default:
+          // dereference, address of, bitwise complement
+          return false;
+      }
+      term.sort = numeric;
+      return true;
+    }
+
+    return false;
+  }
+
+  bool SmtPrinter::translateConstraint(SgExpression* expr, std::string& text) {
+    Term term;
+    if (!translate(expr, term)) return false;
+    text = toBool(term);
+    return true;
+  }
+
+  void SmtPrinter::declareVariables(std::ostream& os, VariableTable* varTbl,
+                                    std::set<std::string>& declared, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      if (!ASTHelper::isPlainName(it->first) || it->second->getType() == T_ARRAY) continue;
+      Sort sort = toSort(it->second->getType());
+      sorts[it->first] = sort;
+      if (declared.insert(it->first).second) {
+        os << indent << "(declare-const " << quote(it->first) << " " << sortName(sort) << ")\n";
+      }
+    }
+  }
+
+  void SmtPrinter::declareReferenced(std::ostream& os, std::set<std::string>& declared, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    for (const std::string& name : referenced) {
+      if (!declared.insert(name).second) continue;
+      auto it = sorts.find(name);
+      Sort sort = it == sorts.end() ? SORT_INT : it->second;
+      os << indent << "(declare-const " << quote(name) << " " << sortName(sort) << ")\n";
+    }
+    referenced.clear();
+  }
+
+  void SmtPrinter::addToTree(Node* root, ConstraintList* cl, const std::string& name,
+                             Path* path) {
+    std::vector<std::string> elements;
+    if (path != nullptr) elements = path->getPaths();
+
+    // values of variables after the steps run so far in terms of entry
+    // values, variables whose value is unknown, and whether every value
+    // is unknown, e.g. after a write through a pointer
+    std::map<std::string, SgExpression*> values;
+    std::set<std::string> unknown;
+    bool lost = false;
+    std::vector<SgExpression*> clones;
+
+    std::vector<std::string> keys;
+    bool relaxed = false;
+    size_t done = 0;
+    for (size_t i = 0; cl != nullptr && i < cl->size(); ++i) {
+      for (; done < cl->getStep(i) && !lost; ++done) {
+        auto block = blocks.find(done < elements.size() ? elements[done] : "");
+        auto loop = loops.find(done < elements.size() ? elements[done] : "");
+        if (block != blocks.end()) {
+          // updates of a block are made all at once
+          std::map<std::string, SgExpression*> updated;
+          VariableTable* varTbl = block->second->getVariableTable();
+          for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+            std::set<std::string> reads;
+            ASTHelper::collectVarNames(it->second->getValue(), reads);
+            bool known = std::none_of(reads.begin(), reads.end(), [&](const std::string& read) {
+              return unknown.count(read) > 0;
+            });
+            if (!ASTHelper::isPlainName(it->first)) {
+              // an array update changes the array, other writes anything
+              if (it->first.find('[') == std::string::npos) lost = true;
+              unknown.insert(ASTHelper::getBaseName(it->first));
+            } else if (!known) {
+              unknown.insert(it->first);
+              values.erase(it->first);
+            } else {
+              clones.push_back(ASTHelper::substitute(it->second->getValue(), values));
+              updated[it->first] = clones.back();
+            }
+          }
+          for (auto& update : updated) {
+            values[update.first] = update.second;
+            unknown.erase(update.first);
+          }
+        } else if (loop != loops.end()) {
+          // values after a loop are not computed
+          std::vector<Loop*> stack(1, loop->second);
+          while (!stack.empty()) {
+            Loop* current = stack.back();
+            stack.pop_back();
+            for (LoopPath* loopPath : *current) {
+              VariableTable* varTbl = loopPath->getVariableTable();
+              for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+                if (!ASTHelper::isPlainName(it->first) &&
+                    it->first.find('[') == std::string::npos) {
+                  lost = true;
+                }
+                unknown.insert(ASTHelper::getBaseName(it->first));
+                values.erase(ASTHelper::getBaseName(it->first));
+              }
+            }
+            stack.insert(stack.end(), current->getInnerLoops().begin(),
+                         current->getInnerLoops().end());
+          }
+        } else {
+          lost = true;
+        }
+      }
+
+      std::set<std::string> reads;
+      ASTHelper::collectVarNames(cl->get(i), reads);
+      bool known = !lost && std::none_of(reads.begin(), reads.end(), [&](const std::string& read) {
+        return unknown.count(read) > 0;
+      });
+
+      std::string text;
+      SgExpression* constraint = cl->getStep(i) == 0 ? cl->get(i) : nullptr;
+      if (known && constraint == nullptr) {
+        clones.push_back(ASTHelper::substitute(cl->get(i), values));
+        constraint = clones.back();
+      }
+      if (!known || !translateConstraint(constraint, text)) {
+        // dropping a constraint over-approximates the path
+        relaxed = true;
+        continue;
+      }
+      keys.push_back(text);
+    }
+
+    for (SgExpression* clone : clones) {
+      if (clone != nullptr) SageInterface::deleteAST(clone);
+    }
+    if (relaxed) {
+      Message::warning("constraints of " + name + " not expressible in SMT-LIB, "
+                       "or read after a loop of the path, are dropped\n");
+    }
+    root->add(keys, relaxed ? name + " (relaxed)" : name);
+  }
+
+  void SmtPrinter::printTree(std::ostream& os, Node* node, int indentLv) {
+    // text and nodes left to print, the next one last, in place of
+    // recursion over the deep trees of long functions
+    struct Piece {
+      std::string text;
+      Node* node;
+      int indentLv;
+    };
+    std::vector<Piece> stack(1, Piece{"", node, indentLv});
+
+    while (!stack.empty()) {
+      Piece piece = stack.back();
+      stack.pop_back();
+      if (piece.node == nullptr) {
+        os << piece.text;
+        continue;
+      }
+
+      std::string&& indent = getIndent(piece.indentLv);
+      for (const std::string& name : piece.node->ends) {
+        os << indent << "(echo \"" << name << "\")\n";
+        os << indent << "(check-sat)\n";
+      }
+      for (auto it = piece.node->order.rbegin(), ie = piece.node->order.rend(); it != ie; ++it) {
+        stack.push_back(Piece{indent + "(pop 1)\n", nullptr, 0});
+        stack.push_back(Piece{"", piece.node->children[*it], piece.indentLv + 1});
+        stack.push_back(Piece{indent + "(push 1)\n" +
+                              indent + getIndent(1) + "(assert " + *it + ")\n", nullptr, 0});
+      }
+    }
+  }
+
+  void SmtPrinter::printLoop(std::ostream& os, Loop* loop, std::set<std::string> declared, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "; loop: " << loop->getName() << "\n";
+    // ranges at the header, computed with -le:ranges only
+    for (auto& range : loop->getRanges()) {
+      os << indent << "; range: " << range.first << " in ["
+         << range.second.lo << ", " << range.second.hi << "]\n";
+    }
+    os << indent << "(push 1)\n";
+
+    std::map<std::string, Sort> outer = sorts;
+    declareVariables(os, loop->getVariableTable(), declared, indentLv + 1);
+
+    Node root;
+    int id = 0;
+    for (LoopPath* loopPath : loop->getPaths()) {
+      std::ostringstream name;
+      name << loop->getName() << ".path" << ++id << (loopPath->canBreakLoop() ? " (break)" : "");
+      addToTree(&root, loopPath->getConstraintList(), name.str());
+    }
+    declareReferenced(os, declared, indentLv + 1);
+    printTree(os, &root, indentLv + 1);
+
+    for (Loop* inner : loop->getInnerLoops()) {
+      printLoop(os, inner, declared, indentLv + 1);
+    }
+
+    os << indent << "(pop 1)\n";
+    sorts = outer;
+  }
+
+  void SmtPrinter::printFunction(std::ostream& os, Function* func, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "; function: " << func->getName() << "\n";
+    if (!func->getSameAs().empty()) {
+      os << indent << "; same as: " << func->getSameAs() << "\n";
+      return;
+    }
+    if (func->getProfileWeight() >= 0) {
+      os << indent << "; profile weight: " << func->getProfileWeight() << "\n";
+    }
+
+    // accesses are collected with -le:fast only
+    const Access& access = func->getAccess();
+    if (!access.mayRead.empty() || !access.mayModify.empty()) {
+      os << indent << "; may read:";
+      for (const std::string& name : access.mayRead) os << " " << name;
+      os << "\n" << indent << "; may modify:";
+      for (const std::string& name : access.mayModify) os << " " << name;
+      os << "\n";
+    }
+    os << indent << "(push 1)\n";
+
+    sorts = globals;
+    referenced.clear();
+    std::set<std::string> declared;
+    declareVariables(os, func->getVariableTable(), declared, indentLv + 1);
+
+    blocks.clear();
+    loops.clear();
+    for (Function* scope : func->getScopes()) {
+      for (Block* block : scope->getBlocks()) {
+        blocks[block->getName()] = block;
+      }
+      for (Loop* loop : scope->getLoops()) {
+        loops[loop->getName()] = loop;
+      }
+    }
+
+    // the paths of each region are a tree of their own
+    for (Function* scope : func->getScopes()) {
+      if (scope != func) {
+        os << getIndent(indentLv + 1) << "; region: " << scope->getName() << "\n";
+      }
+
+      // order paths by name, so that the output is stable
+      std::vector<Path*> paths(scope->getPaths().begin(), scope->getPaths().end());
+      std::sort(paths.begin(), paths.end(), [](Path* a, Path* b) { return a->getName() < b->getName(); });
+
+      if (hasSection("paths") || hasSection("constraints")) {
+        Node root;
+        for (Path* path : paths) {
+          addToTree(&root, path->getConstraints(), path->getName(), path);
+        }
+        declareReferenced(os, declared, indentLv + 1);
+        printTree(os, &root, indentLv + 1);
+      }
+
+      // inner loops are printed within the scope of their outer loop
+      std::set<Loop*> loops;
+      if (hasSection("loops")) {
+        loops = scope->getLoops();
+      }
+      std::set<Loop*> inner;
+      for (Loop* loop : loops) {
+        inner.insert(loop->getInnerLoops().begin(), loop->getInnerLoops().end());
+      }
+      for (Loop* loop : loops) {
+        if (inner.find(loop) == inner.end()) {
+          printLoop(os, loop, declared, indentLv + 1);
+        }
+      }
+    }
+
+    os << indent << "(pop 1)\n";
+  }
+
+  void SmtPrinter::printFunctions(std::ostream& os, const std::set<Function*>& functions, int indentLv) {
+    for (Function* func : functions) {
+      printFunction(os, func, indentLv);
+    }
+  }
+
+  void SmtPrinter::printPaths(std::ostream& os, const std::set<Path*>& paths, int indentLv) {
+    std::set<std::string> declared;
+    Node root;
+    for (Path* path : paths) {
+      addToTree(&root, path->getConstraints(), path->getName());
+    }
+    declareReferenced(os, declared, indentLv);
+    printTree(os, &root, indentLv);
+  }
+
+  void SmtPrinter::printLoops(std::ostream& os, const std::set<Loop*>& loops, int indentLv) {
+    std::set<Loop*> inner;
+    for (Loop* loop : loops) {
+      inner.insert(loop->getInnerLoops().begin(), loop->getInnerLoops().end());
+    }
+    for (Loop* loop : loops) {
+      if (inner.find(loop) == inner.end()) {
+        printLoop(os, loop, std::set<std::string>(), indentLv);
+      }
+    }
+  }
+
+  void SmtPrinter::printLoopPaths(std::ostream& os, const std::set<LoopPath*>& paths, int indentLv) {
+    std::set<std::string> declared;
+    Node root;
+    int id = 0;
+    for (LoopPath* loopPath : paths) {
+      std::ostringstream name;
+      name << "path" << ++id << (loopPath->canBreakLoop() ? " (break)" : "");
+      addToTree(&root, loopPath->getConstraintList(), name.str());
+    }
+    declareReferenced(os, declared, indentLv);
+    printTree(os, &root, indentLv);
+  }
+
+  bool SmtPrinter::printTerm(std::ostream& os, SgExpression* expr) {
+    Term term;
+    if (!translate(expr, term)) return false;
+    os << term.text;
+    return true;
+  }
+
+  void SmtPrinter::printProgram(std::ostream& os, Program* program, int indentLv) {
+    setGlobals(program->getVariableTable());
+
+    std::vector<std::string> functions;
+    for (Function* func : program->getFunctions()) {
+      std::ostringstream oss;
+      printFunction(oss, func, indentLv);
+      functions.push_back(oss.str());
+    }
+    printProgram(os, program, functions, indentLv);
+  }
+
+  void SmtPrinter::printProgram(std::ostream& os, Program* program,
+                                const std::vector<std::string>& functions, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "; program: " << program->getName() << "\n";
+    os << indent << "(set-logic ALL)\n";
+    for (const std::string& func : functions) {
+      os << func;
+    }
+  }
+
+}
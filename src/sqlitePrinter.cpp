@@ -0,0 +1,422 @@
+#include "sqlitePrinter.h"
+#include "astHelper.h"
+#include "message.h"
+#include <cmath>
+#include <sstream>
+
+namespace LE {
+
+  static const char* schema =
+    "CREATE TABLE IF NOT EXISTS programs ("
+    "  id INTEGER PRIMARY KEY, name TEXT NOT NULL);"
+    "CREATE TABLE IF NOT EXISTS functions ("
+    "  id INTEGER PRIMARY KEY, program_id INTEGER REFERENCES programs(id),"
+    "  name TEXT NOT NULL, same_as TEXT, profile_weight REAL, merged_paths INTEGER);"
+    "CREATE TABLE IF NOT EXISTS params ("
+    "  function_id INTEGER NOT NULL REFERENCES functions(id), name TEXT NOT NULL);"
+    // variables of a program, a function or a loop
+    "CREATE TABLE IF NOT EXISTS variables ("
+    "  program_id INTEGER REFERENCES programs(id),"
+    "  function_id INTEGER REFERENCES functions(id),"
+    "  loop_id INTEGER REFERENCES loops(id),"
+    "  name TEXT NOT NULL, type TEXT, init TEXT);"
+    "CREATE TABLE IF NOT EXISTS paths ("
+    "  id INTEGER PRIMARY KEY, function_id INTEGER NOT NULL REFERENCES functions(id),"
+    "  region TEXT, name TEXT NOT NULL, return_value TEXT, has_witness INTEGER,"
+    "  feasible INTEGER);"
+    // inputs for which a path is taken, with -le:witnesses
+    // has_witness of the path is 0 if none was found, NULL if not searched
+    "CREATE TABLE IF NOT EXISTS witnesses ("
+    "  path_id INTEGER NOT NULL REFERENCES paths(id), input TEXT NOT NULL, value REAL);"
+    // ranges of variables at the end of a path or the header of a loop,
+    // with -le:ranges, a bound is NULL if infinite
+    // feasible of the path is 0 if its constraints contradict the ranges,
+    // NULL if not analyzed
+    "CREATE TABLE IF NOT EXISTS ranges ("
+    "  path_id INTEGER REFERENCES paths(id),"
+    "  loop_id INTEGER REFERENCES loops(id),"
+    "  variable TEXT NOT NULL, lo REAL, hi REAL);"
+    // blocks and loops a path runs, in order
+    "CREATE TABLE IF NOT EXISTS path_steps ("
+    "  path_id INTEGER NOT NULL REFERENCES paths(id), position INTEGER NOT NULL,"
+    "  element TEXT NOT NULL);"
+    "CREATE TABLE IF NOT EXISTS blocks ("
+    "  id INTEGER PRIMARY KEY, function_id INTEGER NOT NULL REFERENCES functions(id),"
+    "  region TEXT, name TEXT NOT NULL);"
+    "CREATE TABLE IF NOT EXISTS loops ("
+    "  id INTEGER PRIMARY KEY, function_id INTEGER REFERENCES functions(id),"
+    "  outer_loop_id INTEGER REFERENCES loops(id),"
+    "  region TEXT, name TEXT NOT NULL, parallel INTEGER, merged_paths INTEGER);"
+    "CREATE TABLE IF NOT EXISTS loop_paths ("
+    "  id INTEGER PRIMARY KEY, loop_id INTEGER NOT NULL REFERENCES loops(id),"
+    "  can_break INTEGER NOT NULL);"
+    "CREATE TABLE IF NOT EXISTS inner_loops ("
+    "  loop_path_id INTEGER NOT NULL REFERENCES loop_paths(id), name TEXT NOT NULL);"
+    "CREATE TABLE IF NOT EXISTS constraints ("
+    "  path_id INTEGER REFERENCES paths(id),"
+    "  loop_path_id INTEGER REFERENCES loop_paths(id),"
+    "  position INTEGER NOT NULL, text TEXT NOT NULL,"
+    // steps of the path run before the constraint is checked
+    "  step INTEGER NOT NULL DEFAULT 0);"
+    "CREATE TABLE IF NOT EXISTS updates ("
+    "  block_id INTEGER REFERENCES blocks(id),"
+    "  loop_path_id INTEGER REFERENCES loop_paths(id),"
+    "  variable TEXT NOT NULL, value TEXT);"
+    // variables a function, or one of its blocks or loops, may read
+    // or modify with -le:fast, element is NULL for the function
+    "CREATE TABLE IF NOT EXISTS accesses ("
+    "  function_id INTEGER NOT NULL REFERENCES functions(id), element TEXT,"
+    "  variable TEXT NOT NULL, kind TEXT NOT NULL);"
+    "CREATE INDEX IF NOT EXISTS functions_name ON functions(name);"
+    "CREATE INDEX IF NOT EXISTS functions_program ON functions(program_id);"
+    "CREATE INDEX IF NOT EXISTS params_function ON params(function_id);"
+    "CREATE INDEX IF NOT EXISTS variables_function ON variables(function_id);"
+    "CREATE INDEX IF NOT EXISTS variables_loop ON variables(loop_id);"
+    "CREATE INDEX IF NOT EXISTS paths_function ON paths(function_id);"
+    "CREATE INDEX IF NOT EXISTS path_steps_path ON path_steps(path_id);"
+    "CREATE INDEX IF NOT EXISTS witnesses_path ON witnesses(path_id);"
+    "CREATE INDEX IF NOT EXISTS ranges_path ON ranges(path_id);"
+    "CREATE INDEX IF NOT EXISTS ranges_loop ON ranges(loop_id);"
+    "CREATE INDEX IF NOT EXISTS blocks_function ON blocks(function_id);"
+    "CREATE INDEX IF NOT EXISTS loops_function ON loops(function_id);"
+    "CREATE INDEX IF NOT EXISTS loops_name ON loops(name);"
+    "CREATE INDEX IF NOT EXISTS loop_paths_loop ON loop_paths(loop_id);"
+    "CREATE INDEX IF NOT EXISTS inner_loops_loop_path ON inner_loops(loop_path_id);"
+    "CREATE INDEX IF NOT EXISTS constraints_path ON constraints(path_id);"
+    "CREATE INDEX IF NOT EXISTS constraints_loop_path ON constraints(loop_path_id);"
+    "CREATE INDEX IF NOT EXISTS updates_block ON updates(block_id);"
+    "CREATE INDEX IF NOT EXISTS updates_loop_path ON updates(loop_path_id);"
+    "CREATE INDEX IF NOT EXISTS updates_variable ON updates(variable);"
+    "CREATE INDEX IF NOT EXISTS accesses_function ON accesses(function_id);"
+    "CREATE INDEX IF NOT EXISTS accesses_variable ON accesses(variable);";
+
+  static const char* insertProgram = "INSERT INTO programs (name) VALUES (?)";
+  static const char* insertFunction =
+    "INSERT INTO functions (program_id, name, same_as, profile_weight, merged_paths)"
+    " VALUES (?, ?, ?, ?, ?)";
+  static const char* insertParam = "INSERT INTO params (function_id, name) VALUES (?, ?)";
+  static const char* insertVariable =
+    "INSERT INTO variables (program_id, function_id, loop_id, name, type, init)"
+    " VALUES (?, ?, ?, ?, ?, ?)";
+  static const char* insertPath =
+    "INSERT INTO paths (function_id, region, name, return_value, has_witness, feasible)"
+    " VALUES (?, ?, ?, ?, ?, ?)";
+  static const char* insertWitness =
+    "INSERT INTO witnesses (path_id, input, value) VALUES (?, ?, ?)";
+  static const char* insertRange =
+    "INSERT INTO ranges (path_id, loop_id, variable, lo, hi) VALUES (?, ?, ?, ?, ?)";
+  static const char* insertPathStep =
+    "INSERT INTO path_steps (path_id, position, element) VALUES (?, ?, ?)";
+  static const char* insertBlock =
+    "INSERT INTO blocks (function_id, region, name) VALUES (?, ?, ?)";
+  static const char* insertLoopRow =
+    "INSERT INTO loops (function_id, outer_loop_id, region, name, parallel, merged_paths)"
+    " VALUES (?, ?, ?, ?, ?, ?)";
+  static const char* insertLoopPath =
+    "INSERT INTO loop_paths (loop_id, can_break) VALUES (?, ?)";
+  static const char* insertInnerLoop =
+    "INSERT INTO inner_loops (loop_path_id, name) VALUES (?, ?)";
+  static const char* insertConstraint =
+    "INSERT INTO constraints (path_id, loop_path_id, position, text, step) VALUES (?, ?, ?, ?, ?)";
+  static const char* insertUpdate =
+    "INSERT INTO updates (block_id, loop_path_id, variable, value) VALUES (?, ?, ?, ?)";
+  static const char* insertAccessRow =
+    "INSERT INTO accesses (function_id, element, variable, kind) VALUES (?, ?, ?, ?)";
+
+  SqlitePrinter::SqlitePrinter(const std::string& file):
+    file(file), db(nullptr), rows(0), programId(0), functionId(0), loopId(0) {
+    // the destructor doesn't run if the constructor fails
+    if (sqlite3_open(file.c_str(), &db) != SQLITE_OK) {
+      std::string error = sqlite3_errmsg(db);
+      sqlite3_close(db);
+      Message::error("can't open database " + file + ": " + error);
+    }
+    try {
+      // rows are only readable after the run anyway
+      execute("PRAGMA synchronous = OFF");
+      execute(schema);
+    } catch (const Error&) {
+      sqlite3_close(db);
+      throw;
+    }
+  }
+
+  SqlitePrinter::~SqlitePrinter() {
+    // a destructor must not throw
+    if (rows > 0 && sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+      Message::warning("can't write database " + file + ": " + sqlite3_errmsg(db));
+    }
+    for (auto& statement : statements) {
+      sqlite3_finalize(statement.second);
+    }
+    sqlite3_close(db);
+  }
+
+  void SqlitePrinter::execute(const char* sql) {
+    char* message = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &message) != SQLITE_OK) {
+      std::string error = message != nullptr ? message : sqlite3_errmsg(db);
+      sqlite3_free(message);
+      Message::error("can't write database " + file + ": " + error);
+    }
+  }
+
+  long long SqlitePrinter::insert(const char* sql, const std::vector<Value>& values) {
+    sqlite3_stmt*& stmt = statements[sql];
+    if (stmt == nullptr && sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+      Message::error("can't write database " + file + ": " + sqlite3_errmsg(db));
+    }
+
+    if (rows == 0) {
+      execute("BEGIN");
+    }
+
+    for (size_t i = 0; i < values.size(); ++i) {
+      const Value& value = values[i];
+      int index = i + 1;
+      switch (value.kind) {
+      case Value::INTEGER:
+        sqlite3_bind_int64(stmt, index, value.integer);
+        break;
+      case Value::REAL:
+        sqlite3_bind_double(stmt, index, value.real);
+        break;
+      case Value::TEXT:
+        sqlite3_bind_text(stmt, index, value.text.c_str(), value.text.length(), SQLITE_TRANSIENT);
+        break;
+      default:
+        sqlite3_bind_null(stmt, index);
+      }
+    }
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+      Message::error("can't write database " + file + ": " + sqlite3_errmsg(db));
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    long long id = sqlite3_last_insert_rowid(db);
+
+    if (++rows >= batchSize) {
+      execute("COMMIT");
+      rows = 0;
+    }
+    return id;
+  }
+
+  SqlitePrinter::Value SqlitePrinter::idOrNull(long long id) {
+    return id == 0 ? Value() : Value(id);
+  }
+
+  std::string SqlitePrinter::expressionText(SgExpression* expr) {
+    std::ostringstream oss;
+    printExpression(oss, expr);
+    return oss.str();
+  }
+
+  void SqlitePrinter::insertVariables(VariableTable* varTbl, long long funcId, long long loopId) {
+    if (!hasSection("variables") && !hasSection("initialize")) return;
+
+    // a table of neither a function nor a loop is of the program
+    Value program = funcId == 0 && loopId == 0 ? idOrNull(programId) : Value();
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      Variable* var = it->second;
+      Value init;
+      if (hasSection("initialize") && var->getInitValue() != nullptr) {
+        init = expressionText(var->getInitValue());
+      }
+      insert(insertVariable, { program, idOrNull(funcId), idOrNull(loopId), var->getName(),
+                               ASTHelper::getTypeString(var->getType()), init });
+    }
+  }
+
+  void SqlitePrinter::insertConstraints(ConstraintList* cl, long long pathId, long long loopPathId) {
+    for (size_t i = 0; i < cl->size(); ++i) {
+      insert(insertConstraint, { idOrNull(pathId), idOrNull(loopPathId), static_cast<int>(i),
+                                 expressionText(cl->get(i)), static_cast<long long>(cl->getStep(i)) });
+    }
+  }
+
+  void SqlitePrinter::insertUpdates(VariableTable* varTbl, long long blockId, long long loopPathId) {
+    for (auto it = varTbl->begin(), ie = varTbl->end(); it != ie; ++it) {
+      Variable* var = it->second;
+      insert(insertUpdate, { idOrNull(blockId), idOrNull(loopPathId), var->getName(),
+                             expressionText(var->getValue()) });
+    }
+  }
+
+  void SqlitePrinter::insertAccess(const Access& access, const Value& element) {
+    for (const std::string& name : access.mayRead) {
+      insert(insertAccessRow, { functionId, element, name, "read" });
+    }
+    for (const std::string& name : access.mayModify) {
+      insert(insertAccessRow, { functionId, element, name, "modify" });
+    }
+  }
+
+  void SqlitePrinter::insertRanges(const std::map<std::string, Interval>& ranges,
+                                   long long pathId, long long loopId) {
+    for (auto& range : ranges) {
+      Value lo = std::isinf(range.second.lo) ? Value() : Value(range.second.lo);
+      Value hi = std::isinf(range.second.hi) ? Value() : Value(range.second.hi);
+      insert(insertRange, { idOrNull(pathId), idOrNull(loopId), range.first, lo, hi });
+    }
+  }
+
+  long long SqlitePrinter::insertLoop(Loop* loop, long long outerId) {
+    Value regionName = region.empty() ? Value() : Value(region);
+    long long id = insert(insertLoopRow, { idOrNull(functionId), idOrNull(outerId), regionName,
+                                           loop->getName(), loop->isParallel() ? 1 : 0,
+                                           loop->getMergedPaths() });
+    insertVariables(loop->getVariableTable(), 0, id);
+    insertRanges(loop->getRanges(), 0, id);
+
+    long long saved = loopId;
+    loopId = id;
+    printLoopPaths(std::cout, loop->getPaths());
+    loopId = saved;
+    return id;
+  }
+
+  void SqlitePrinter::insertScope(Function* scope) {
+    if (hasSection("paths") || hasSection("constraints") || hasSection("returns")) {
+      printPaths(std::cout, scope->getPaths());
+    }
+    if (hasSection("blocks")) {
+      Value regionName = region.empty() ? Value() : Value(region);
+      for (Block* block : scope->getBlocks()) {
+        long long blockId = insert(insertBlock, { idOrNull(functionId), regionName, block->getName() });
+        insertUpdates(block->getVariableTable(), blockId, 0);
+      }
+    }
+    if (hasSection("loops")) {
+      printLoops(std::cout, scope->getLoops());
+    }
+  }
+
+  void SqlitePrinter::printPaths(std::ostream& os, const std::set<Path*>& paths, int indentLv) {
+    // as in JsonPrinter::printPath, sections 'constraints' and 'returns'
+    // without 'paths' only fill those fields
+    bool all = hasSection("paths");
+    Value regionName = region.empty() ? Value() : Value(region);
+    for (Path* path : paths) {
+      Value retVal;
+      if ((all || hasSection("returns")) && path->getReturnValue() != nullptr) {
+        retVal = expressionText(path->getReturnValue());
+      }
+      Value hasWitness = path->isWitnessSearched() ? Value(path->hasWitness() ? 1 : 0) : Value();
+      Value feasible = path->isRangesAnalyzed() ? Value(path->isInfeasible() ? 0 : 1) : Value();
+      long long pathId = insert(insertPath, { idOrNull(functionId), regionName, path->getName(),
+                                              retVal, hasWitness, feasible });
+
+      if (all || hasSection("constraints")) {
+        insertConstraints(path->getConstraints(), pathId, 0);
+        for (auto& input : path->getWitness()) {
+          insert(insertWitness, { pathId, input.first, input.second });
+        }
+        insertRanges(path->getRanges(), pathId, 0);
+      }
+      if (all) {
+        int position = 0;
+        for (const std::string& element : path->getPaths()) {
+          insert(insertPathStep, { pathId, position++, element });
+        }
+      }
+    }
+  }
+
+  void SqlitePrinter::printLoops(std::ostream& os, const std::set<Loop*>& loops, int indentLv) {
+    // outer loops first, so that inner loops know the id of their outer loop
+    std::set<Loop*> inner;
+    for (Loop* loop : loops) {
+      inner.insert(loop->getInnerLoops().begin(), loop->getInnerLoops().end());
+    }
+
+    std::set<Loop*> inserted;
+    std::vector<std::pair<Loop*, long long> > stack;
+    for (Loop* loop : loops) {
+      if (inner.count(loop) == 0) {
+        stack.push_back(std::make_pair(loop, 0LL));
+      }
+    }
+    while (!stack.empty()) {
+      Loop* loop = stack.back().first;
+      long long outerId = stack.back().second;
+      stack.pop_back();
+      if (!inserted.insert(loop).second) continue;
+
+      long long id = insertLoop(loop, outerId);
+      for (Loop* innerLoop : loop->getInnerLoops()) {
+        stack.push_back(std::make_pair(innerLoop, id));
+      }
+    }
+  }
+
+  void SqlitePrinter::printLoopPaths(std::ostream& os, const std::set<LoopPath*>& paths, int indentLv) {
+    for (LoopPath* loopPath : paths) {
+      long long loopPathId = insert(insertLoopPath, { idOrNull(loopId), loopPath->canBreakLoop() ? 1 : 0 });
+      insertConstraints(loopPath->getConstraintList(), 0, loopPathId);
+      insertUpdates(loopPath->getVariableTable(), 0, loopPathId);
+      for (const std::string& name : loopPath->getInnerLoops()) {
+        insert(insertInnerLoop, { loopPathId, name });
+      }
+    }
+  }
+
+  void SqlitePrinter::printFunction(std::ostream& os, Function* func, int indentLv) {
+    Value sameAs = func->getSameAs().empty() ? Value() : Value(func->getSameAs());
+    Value weight = func->getProfileWeight() >= 0 ? Value(func->getProfileWeight()) : Value();
+    functionId = insert(insertFunction, { idOrNull(programId), func->getName(), sameAs, weight,
+                                          func->getMergedPaths() });
+
+    // a function extracted before in this run is only referred to
+    if (func->getSameAs().empty()) {
+      insertVariables(func->getVariableTable(), functionId, 0);
+
+      if (hasSection("input_variables")) {
+        for (const std::string& param : func->getParams()) {
+          insert(insertParam, { functionId, param });
+        }
+      }
+
+      if (func->getRegions().empty()) {
+        insertScope(func);
+      }
+      for (Function* scope : func->getRegions()) {
+        region = scope->getName();
+        insertScope(scope);
+      }
+      region.clear();
+
+      insertAccess(func->getAccess(), Value());
+      for (auto& access : func->getAccesses()) {
+        insertAccess(access.second, access.first);
+      }
+    }
+    functionId = 0;
+  }
+
+  void SqlitePrinter::printFunctions(std::ostream& os, const std::set<Function*>& functions, int indentLv) {
+    for (Function* func : functions) {
+      printFunction(os, func, indentLv);
+    }
+  }
+
+  void SqlitePrinter::printProgram(std::ostream& os, Program* program, int indentLv) {
+    programId = insert(insertProgram, { program->getName() });
+    insertVariables(program->getVariableTable(), 0, 0);
+    printFunctions(os, program->getFunctions(), indentLv);
+    programId = 0;
+  }
+
+  void SqlitePrinter::printProgram(std::ostream& os, Program* program,
+                                   const std::vector<std::string>& functions, int indentLv) {
+    // functions printed by workers are text and can't be stored,
+    // so -le:format=sqlite extracts in this process, see Options::parse
+    if (!functions.empty()) {
+      Message::warning("functions of " + program->getName() + " printed by workers are not stored in "
+                       + file);
+    }
+    printProgram(os, program, indentLv);
+  }
+
+}
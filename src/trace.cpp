@@ -0,0 +1,109 @@
+#include "trace.h"
+#include "message.h"
+#include "json.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace LE {
+
+  // trace file, -1 means no trace
+  static int traceFd = -1;
+
+  // process that opened the trace, shown as the process of every event
+  static pid_t ownerPid = 0;
+
+  static std::chrono::steady_clock::time_point origin;
+
+  static void writeEvent(const std::string& event) {
+    std::string&& str = event + ",\n";
+    ssize_t n = write(traceFd, str.data(), str.size());
+    (void)n;
+  }
+
+  // close the array with an event without trailing comma
+  // workers leave with _exit, so only the owner gets here
+  static void closeAtExit() {
+    if (traceFd < 0 || getpid() != ownerPid) return;
+
+    std::ostringstream oss;
+    oss << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << ownerPid
+        << ", \"args\": {\"name\": \"le\"}}\n]\n";
+    const std::string& str = oss.str();
+    ssize_t n = write(traceFd, str.data(), str.size());
+    (void)n;
+    close(traceFd);
+    traceFd = -1;
+  }
+
+  void Trace::configure(const std::string& file) {
+    if (file.empty() || traceFd >= 0) return;
+
+    traceFd = open(file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_TRUNC, 0644);
+    if (traceFd < 0) {
+      Message::warning("can't open trace file " + file);
+      return;
+    }
+    ownerPid = getpid();
+    origin = std::chrono::steady_clock::now();
+
+    ssize_t n = write(traceFd, "[\n", 2);
+    (void)n;
+    nameThread("main");
+    std::atexit(closeAtExit);
+  }
+
+  bool Trace::isEnabled() {
+    return traceFd >= 0;
+  }
+
+  long Trace::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - origin).count();
+  }
+
+  void Trace::span(const char* category, const std::string& name, long begin, long end,
+                   const char* argName, const std::string& arg) {
+    if (traceFd < 0) return;
+
+    std::ostringstream oss;
+    oss << "{\"name\": " << jsonString(name) << ", \"cat\": \"" << category
+        << "\", \"ph\": \"X\", \"ts\": " << begin << ", \"dur\": " << end - begin
+        << ", \"pid\": " << ownerPid << ", \"tid\": " << getpid();
+    if (argName[0] != '\0') {
+      oss << ", \"args\": {\"" << argName << "\": " << jsonString(arg) << "}";
+    }
+    oss << "}";
+    writeEvent(oss.str());
+  }
+
+  void Trace::nameThread(const std::string& name) {
+    if (traceFd < 0) return;
+
+    std::ostringstream oss;
+    oss << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << ownerPid
+        << ", \"tid\": " << getpid() << ", \"args\": {\"name\": " << jsonString(name) << "}}";
+    writeEvent(oss.str());
+  }
+
+  TraceScope::TraceScope(const char* category, const std::string& name,
+                         const char* argName, const std::string& arg):
+    category(category), argName(argName), begin(-1) {
+    if (Trace::isEnabled()) {
+      this->name = name;
+      this->arg = arg;
+      begin = Trace::now();
+    }
+  }
+
+  TraceScope::~TraceScope() {
+    if (begin >= 0) {
+      Trace::span(category, name, begin, Trace::now(), argName, arg);
+    }
+  }
+
+}
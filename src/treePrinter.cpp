@@ -0,0 +1,202 @@
+#include "treePrinter.h"
+#include <algorithm>
+#include <sstream>
+
+namespace LE {
+
+  template <class T>
+  void TreePrinter::addToTree(Node<T>* root, ConstraintList* cl, T* end,
+                              const std::vector<std::string>& steps) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < cl->size(); ++i) {
+      std::ostringstream oss;
+      printExpression(oss, cl->get(i));
+      size_t step = cl->getStep(i);
+      if (step > 0 && step <= steps.size()) {
+        oss << '\n' << steps[step - 1];
+      }
+      keys.push_back(oss.str());
+    }
+    root->add(keys, end);
+  }
+
+  template <class T>
+  void TreePrinter::printNode(std::ostream& os, Node<T>* node, int indentLv) {
+    // alternatives of a node: a path ending here,
+    // a condition with its negation, or a single condition
+    struct Branch {
+      T* end;
+      std::string condition;
+      std::string after;
+      Node<T>* thenNode;
+      Node<T>* elseNode;
+    };
+
+    // text, nodes and leaves left to print, the next one last, in place
+    // of recursion over the deep trees of long functions
+    struct Piece {
+      std::string text;
+      Node<T>* node;
+      T* end;
+      int indentLv;
+    };
+    std::vector<Piece> stack(1, Piece{"", node, nullptr, indentLv});
+
+    while (!stack.empty()) {
+      Piece piece = stack.back();
+      stack.pop_back();
+      if (piece.end != nullptr) {
+        printLeaf(os, piece.end, piece.indentLv);
+        continue;
+      }
+      if (piece.node == nullptr) {
+        os << piece.text;
+        continue;
+      }
+
+      Node<T>* node = piece.node;
+      std::vector<Branch> branches;
+      for (T* end : node->ends) {
+        branches.push_back({end, "", "", nullptr, nullptr});
+      }
+
+      std::set<std::string> paired;
+      for (const std::string& key : node->order) {
+        if (paired.count(key)) continue;
+
+        // a condition and its negation are checked after the same step
+        std::string::size_type split = std::min(key.find('\n'), key.length());
+        std::string text = key.substr(0, split);
+        std::string suffix = key.substr(split);
+        std::string after = suffix.empty() ? "" : suffix.substr(1);
+
+        // negation of c is printed as '(!c)', see Printer::printExpression
+        std::string cond = text, negation = "(!" + text + ")";
+        if (text.compare(0, 2, "(!") == 0 &&
+            node->children.count(text.substr(2, text.length() - 3) + suffix)) {
+          cond = text.substr(2, text.length() - 3);
+          negation = text;
+        }
+
+        if (node->children.count(negation + suffix) && node->children.count(cond + suffix)) {
+          paired.insert(cond + suffix);
+          paired.insert(negation + suffix);
+          branches.push_back({nullptr, cond, after, node->children[cond + suffix],
+                              node->children[negation + suffix]});
+        } else {
+          branches.push_back({nullptr, text, after, node->children[key], nullptr});
+        }
+      }
+
+      // pieces of this node in the order they are printed
+      std::vector<Piece> pieces;
+      auto text = [&](const std::string& t) { pieces.push_back(Piece{t, nullptr, nullptr, 0}); };
+
+      std::string&& indent = getIndent(piece.indentLv);
+      int lv = piece.indentLv;
+      if (branches.size() != 1) {
+        text(indent + "{\n" + indent + getIndent(1) + "'cases': [\n");
+        lv = piece.indentLv + 2;
+      }
+
+      for (size_t i = 0; i < branches.size(); ++i) {
+        const Branch& branch = branches[i];
+        if (branch.end != nullptr) {
+          pieces.push_back(Piece{"", nullptr, branch.end, lv});
+        } else {
+          std::string&& inner = getIndent(lv + 1);
+          text(getIndent(lv) + "{\n" +
+               inner + "'if': '" + branch.condition + "',\n");
+          if (!branch.after.empty()) {
+            text(inner + "'after': '" + branch.after + "',\n");
+          }
+          text(inner + "'then':\n");
+          pieces.push_back(Piece{"", branch.thenNode, nullptr, lv + 2});
+          if (branch.elseNode != nullptr) {
+            text(",\n" + inner + "'else':\n");
+            pieces.push_back(Piece{"", branch.elseNode, nullptr, lv + 2});
+          }
+          text("\n" + getIndent(lv) + "}");
+        }
+        text(i + 1 == branches.size() ? "" : ",\n");
+      }
+
+      if (branches.size() != 1) {
+        text("\n" + indent + getIndent(1) + "]\n" + indent + "}");
+      }
+      stack.insert(stack.end(), pieces.rbegin(), pieces.rend());
+    }
+  }
+
+  void TreePrinter::printLeaf(std::ostream& os, Path* path, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "{\n";
+    os << getIndent(indentLv + 1) << "'name': '" << path->getName() << "',\n";
+
+    JsonPrinter::printPaths(os, path->getPaths(), indentLv + 1);
+    os << ",\n";
+
+    printReturnValue(os, path->getReturnValue(), indentLv + 1);
+    if (path->isWitnessSearched()) {
+      os << ",\n";
+      printWitness(os, path, indentLv + 1);
+    }
+    if (path->isRangesAnalyzed()) {
+      os << ",\n";
+      printPathRanges(os, path, indentLv + 1);
+    }
+    os << '\n';
+
+    os << indent << "}";
+  }
+
+  void TreePrinter::printLeaf(std::ostream& os, LoopPath* loopPath, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "{\n";
+
+    printLoopPath(os, loopPath->getInnerLoops(), loopPath->getVariableTable(), indentLv + 1);
+    os << ",\n";
+
+    printCanBreak(os, loopPath->canBreakLoop(), indentLv + 1);
+    os << '\n';
+
+    os << indent << "}";
+  }
+
+  void TreePrinter::printPaths(std::ostream& os, const std::set<Path*>& paths, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'decision_tree':";
+    if (paths.empty()) {
+      os << " {}";
+      return;
+    }
+
+    // order paths by name, so that the output is stable
+    std::vector<Path*> sorted(paths.begin(), paths.end());
+    std::sort(sorted.begin(), sorted.end(), [](Path* a, Path* b) { return a->getName() < b->getName(); });
+
+    Node<Path> root;
+    for (Path* path : sorted) {
+      addToTree(&root, path->getConstraints(), path, path->getPaths());
+    }
+    os << '\n';
+    printNode(os, &root, indentLv + 1);
+  }
+
+  void TreePrinter::printLoopPaths(std::ostream& os, const std::set<LoopPath*>& paths, int indentLv) {
+    std::string&& indent = getIndent(indentLv);
+    os << indent << "'decision_tree':";
+    if (paths.empty()) {
+      os << " {}";
+      return;
+    }
+
+    Node<LoopPath> root;
+    for (LoopPath* loopPath : paths) {
+      addToTree(&root, loopPath->getConstraintList(), loopPath, std::vector<std::string>());
+    }
+    os << '\n';
+    printNode(os, &root, indentLv + 1);
+  }
+
+}
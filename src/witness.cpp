@@ -0,0 +1,117 @@
+#include "witness.h"
+#include "evaluator.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+namespace LE {
+
+  const size_t WitnessSampler::chunkSize;
+
+  std::vector<double> WitnessSampler::collectConstants(Function* func) {
+    std::set<double> constants = { 0, 1, -1 };
+
+    for (Function* scope : func->getScopes()) {
+      for (Path* path : scope->getPaths()) {
+        for (SgExpression* constraint : *path->getConstraints()) {
+          std::vector<SgNode*> stack(1, constraint);
+          while (!stack.empty()) {
+            SgNode* node = stack.back();
+            stack.pop_back();
+            if (node == nullptr) continue;
+
+            if (SgValueExp* value = dynamic_cast<SgValueExp*>(node)) {
+              std::string&& str = value->get_constant_folded_value_as_string();
+              char* end = nullptr;
+              double c = std::strtod(str.c_str(), &end);
+              if (!str.empty() && *end == '\0' && std::isfinite(c)) {
+                constants.insert({ c, c - 1, c + 1, -c });
+              }
+            }
+
+            std::vector<SgNode*> children = node->get_traversalSuccessorContainer();
+            stack.insert(stack.end(), children.begin(), children.end());
+          }
+        }
+      }
+    }
+
+    return std::vector<double>(constants.begin(), constants.end());
+  }
+
+  void WitnessSampler::sample(Function* func, long samples) {
+    CompiledFunction* compiled = Evaluator::compile(func);
+    if (compiled == nullptr) return;
+
+    // globals and locals without initial value are sampled as well,
+    // they come after the parameters
+    std::vector<std::string> inputs = compiled->getInputs();
+    const std::vector<std::string>& freeVars = compiled->getFreeVars();
+    const size_t nParams = inputs.size();
+    inputs.insert(inputs.end(), freeVars.begin(), freeVars.end());
+    const size_t nPaths = compiled->getPathCount();
+
+    // uniform values cover the constants and some more
+    std::vector<double>&& constants = collectConstants(func);
+    double range = 1000;
+    for (double c : constants) {
+      range = std::max(range, 2 * std::fabs(c));
+    }
+
+    std::mt19937_64 random(std::hash<std::string>()(func->getName()));
+    std::uniform_int_distribution<size_t> pick(0, constants.size() - 1);
+    std::uniform_real_distribution<double> uniform(-range, range);
+    std::bernoulli_distribution fromConstants(0.5);
+
+    std::vector<std::vector<double> > values(inputs.size(), std::vector<double>(chunkSize));
+    std::vector<const double*> in, free;
+    for (size_t k = 0; k < inputs.size(); ++k) {
+      (k < nParams ? in : free).push_back(values[k].data());
+    }
+
+    // witnesses[p] is an index into the current chunk until it's saved,
+    // then it stays non-negative so that the path is skipped
+    std::vector<long> witnesses(nPaths, -1);
+    std::vector<bool> saved(nPaths, false);
+    std::map<std::string, std::map<std::string, double> > found;
+    size_t missing = nPaths;
+    for (long done = 0; done < samples && missing > 0; done += chunkSize) {
+      size_t n = samples - done < (long)chunkSize ? samples - done : chunkSize;
+      for (size_t k = 0; k < inputs.size(); ++k) {
+        bool isInt = k < nParams ? compiled->isIntegral(k) : compiled->isFreeIntegral(k - nParams);
+        for (size_t i = 0; i < n; ++i) {
+          double v = fromConstants(random) ? constants[pick(random)] : uniform(random);
+          values[k][i] = isInt ? std::trunc(v) : v;
+        }
+      }
+
+      missing = compiled->findWitnesses(in, free, n, witnesses);
+      for (size_t p = 0; p < nPaths; ++p) {
+        if (witnesses[p] < 0 || saved[p]) continue;
+        std::map<std::string, double>& witness = found[compiled->getPathName(p)];
+        for (size_t k = 0; k < inputs.size(); ++k) {
+          witness[inputs[k]] = values[k][witnesses[p]];
+        }
+        saved[p] = true;
+      }
+    }
+    delete compiled;
+
+    for (Function* scope : func->getScopes()) {
+      for (Path* path : scope->getPaths()) {
+        auto witness = found.find(path->getName());
+        if (witness != found.end()) {
+          path->setWitness(witness->second);
+        } else {
+          path->setNoWitness();
+        }
+      }
+    }
+  }
+
+}
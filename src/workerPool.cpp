@@ -0,0 +1,203 @@
+#include "workerPool.h"
+#include "message.h"
+#include "trace.h"
+#include "diagnostics.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace LE {
+
+  // every task output is sent to parent as a frame:
+  // task index, length of output, output
+  // the last frame of a worker carries its diagnostics counts
+  static const int32_t diagnosticsFrame = -1;
+
+  struct FrameHeader {
+    int32_t task;
+    uint64_t length;
+  };
+
+  // write all bytes to fd, return false if pipe is broken
+  static bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+      ssize_t n = write(fd, data, size);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        return false;
+      }
+      data += n;
+      size -= n;
+    }
+    return true;
+  }
+
+  // body of a worker process, never returns
+  static void runWorker(int id, int workers, int nTasks,
+                        const WorkerPool::Task& task, int fd) {
+    // counts inherited from parent are counted there already,
+    // and parent writes the warnings of all workers
+    Diagnostics::reset();
+    Diagnostics::defer();
+    Trace::nameThread("worker " + std::to_string(id));
+
+    bool broken = false;
+    for (int i = id; i < nTasks && !broken; i += workers) {
+      // a failed task is not reported, so the parent runs it again
+      // and gets the error itself
+      std::ostringstream oss;
+      Diagnostics::mark();
+      try {
+        task(i, oss);
+      } catch (const Error&) {
+        Diagnostics::rollback();
+        break;
+      }
+      const std::string& output = oss.str();
+
+      FrameHeader header;
+      header.task = i;
+      header.length = output.size();
+      broken = !writeAll(fd, reinterpret_cast<const char*>(&header), sizeof(header)) ||
+               !writeAll(fd, output.data(), output.size());
+    }
+
+    if (!broken) {
+      const std::string& counts = Diagnostics::serialize();
+      FrameHeader header;
+      header.task = diagnosticsFrame;
+      header.length = counts.size();
+      if (writeAll(fd, reinterpret_cast<const char*>(&header), sizeof(header))) {
+        writeAll(fd, counts.data(), counts.size());
+      }
+    }
+    close(fd);
+
+    // skip destructors of objects shared with parent
+    std::cout.flush();
+    std::cerr.flush();
+    _exit(0);
+  }
+
+  // decode complete frames in buffer and store them in results
+  static void decodeFrames(const std::string& buffer,
+                           std::vector<std::string>& results,
+                           std::vector<bool>& done) {
+    size_t pos = 0;
+    while (buffer.size() - pos >= sizeof(FrameHeader)) {
+      FrameHeader header;
+      std::memcpy(&header, buffer.data() + pos, sizeof(header));
+      if (buffer.size() - pos - sizeof(header) < header.length) break;
+
+      pos += sizeof(header);
+      if (header.task == diagnosticsFrame) {
+        Diagnostics::merge(buffer.substr(pos, header.length));
+      } else if (header.task >= 0 && header.task < (int32_t)results.size()) {
+        results[header.task] = buffer.substr(pos, header.length);
+        done[header.task] = true;
+      }
+      pos += header.length;
+    }
+  }
+
+  std::vector<std::string> WorkerPool::run(int nTasks, const Task& task) {
+    std::vector<std::string> results(nTasks);
+    std::vector<bool> done(nTasks, false);
+    int n = workers < nTasks ? workers : nTasks;
+
+    // buffered output would be written again by every worker
+    std::cout.flush();
+    std::cerr.flush();
+
+    std::vector<pid_t> pids;
+    std::vector<int> fds;
+    for (int k = 0; k < n; ++k) {
+      int pipeFds[2];
+      if (pipe(pipeFds) != 0) {
+        Message::warning("pipe failed, remaining tasks run in parent");
+        break;
+      }
+
+      pid_t pid = fork();
+      if (pid < 0) {
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+        Message::warning("fork failed, remaining tasks run in parent");
+        break;
+      }
+
+      if (pid == 0) {
+        close(pipeFds[0]);
+        for (int fd : fds) close(fd);
+        runWorker(k, n, nTasks, task, pipeFds[1]);
+      }
+
+      close(pipeFds[1]);
+      pids.push_back(pid);
+      fds.push_back(pipeFds[0]);
+    }
+
+    // read outputs of all workers until every pipe is closed
+    std::vector<std::string> buffers(fds.size());
+    std::vector<struct pollfd> polls(fds.size());
+    for (size_t i = 0; i < fds.size(); ++i) {
+      polls[i].fd = fds[i];
+      polls[i].events = POLLIN;
+    }
+
+    size_t open = fds.size();
+    char chunk[65536];
+    while (open > 0) {
+      if (poll(polls.data(), polls.size(), -1) < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+
+      for (size_t i = 0; i < polls.size(); ++i) {
+        if (polls[i].fd < 0 || polls[i].revents == 0) continue;
+
+        ssize_t len = read(polls[i].fd, chunk, sizeof(chunk));
+        if (len < 0 && errno == EINTR) continue;
+        if (len > 0) {
+          buffers[i].append(chunk, len);
+        } else {
+          close(polls[i].fd);
+          polls[i].fd = -1;
+          --open;
+        }
+      }
+    }
+
+    for (const struct pollfd& p : polls) {
+      if (p.fd >= 0) close(p.fd);
+    }
+
+    for (pid_t pid : pids) {
+      int status;
+      while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    }
+
+    for (const std::string& buffer : buffers) {
+      decodeFrames(buffer, results, done);
+    }
+
+    for (int i = 0; i < nTasks; ++i) {
+      if (!done[i]) {
+        std::ostringstream oss;
+        task(i, oss);
+        results[i] = oss.str();
+      }
+    }
+
+    return results;
+  }
+
+}